@@ -18,6 +18,16 @@ module.exports = {
         endpoint: 'https://<oracle-specific>', // Should be changed to suit the oracle
         oracleAccount: '0x111111111111111111111111111111111111111', // Should be changed to suit the oracle
         privateKey: 'ABC434DCF...', // Should be changed to suit the oracle to match th oracle account used on the EVM chain.
-        chainId: 2 // This is the chainId for BSC. 1 is for ETH
-    }
+        chainId: 2, // This is the chainId for BSC. 1 is for ETH
+        // blocksToWait: 5, // Confirmations required before a log is processed
+        // logRange: 100, // Number of blocks requested per eth_getLogs call
+        // logConcurrency: 4, // Number of eth_getLogs calls kept in flight while catching up
+        // claimCheckpoints: false, // Report claims with one claimckpt per logRange blocks, all oracles must use the same logRange
+    },
+    // Only used by loadgen.js against a local single node chain, never a public one
+    // loadgen: {
+    //     endpoint: 'http://127.0.0.1:8888',
+    //     privateKey: '5K...', // key for eosio, the contracts, the oracles and the load accounts
+    //     oracles: ['oracle1', 'oracle2', 'oracle3', 'oracle4', 'oracle5'],
+    // }
 }
@@ -36,7 +36,7 @@ const run = async () => {
         // console.log(res)
 
         res.rows.forEach(r => {
-            if (r.signatures.length < 3){
+            if (r.signatures.length + (r.signature_count || 0) < 3){
                 incomplete.push(r);
             }
         });
@@ -0,0 +1,111 @@
+'use strict';
+
+/*
+Helpers for ingesting teleport contract logs from an EVM JSON-RPC endpoint.
+
+Log ranges are fetched with several eth_getLogs requests in flight at once but are handed back
+strictly in block order, so the caller can persist its cursor after every range. Event data is
+decoded by hand for the two fixed layouts in TeleportToken.sol instead of going through a generic
+ABI decoder.
+ */
+
+const claimed_topic = '0xf20fc6923b8057dd0c3b606483fcaa038229bb36ebc35a0040e3eaa39cf97b17';
+const teleport_topic = '0x622824274e0937ee319b036740cd0887131781bc2032b47eac3e88a1be17f5d5';
+
+// 32 byte ABI word `index` of hex encoded log data, without the 0x prefix
+const word = (data, index) => data.substr(2 + index * 64, 64);
+
+// event Teleport(address indexed from, string to, uint tokens, uint chainId)
+const decode_teleport = (data) => {
+    const to_offset = parseInt(word(data, 0), 16) / 32;
+    const to_length = parseInt(word(data, to_offset), 16);
+    const to_hex = data.substr(2 + (to_offset + 1) * 64, to_length * 2);
+
+    return {
+        to: Buffer.from(to_hex, 'hex').toString('utf8'),
+        tokens: BigInt(`0x${word(data, 1)}`),
+        chain_id: BigInt(`0x${word(data, 2)}`)
+    };
+}
+
+// event Claimed(uint64 id, address to, uint tokens)
+const decode_claimed = (data) => {
+    return {
+        id: BigInt(`0x${word(data, 0)}`),
+        to: `0x${word(data, 1).substr(24)}`,
+        tokens: BigInt(`0x${word(data, 2)}`)
+    };
+}
+
+/*
+Yields { from_block, to_block, logs } for consecutive ranges of up to `step` blocks between from_block
+and to_block inclusive, keeping up to `concurrency` getLogs requests in flight.
+ */
+async function* log_ranges(provider, query, from_block, to_block, step, concurrency) {
+    const in_flight = [];
+    let next_block = from_block;
+
+    const request = () => {
+        const range_from = next_block;
+        // ranges end on multiples of step so every oracle sees the same block windows
+        const range_to = Math.min(range_from - (range_from % step) + step - 1, to_block);
+        next_block = range_to + 1;
+
+        const logs = provider.getLogs({ ...query, fromBlock: range_from, toBlock: range_to });
+        // errors are raised when the range is awaited in order below
+        logs.catch(() => {});
+        in_flight.push({ from_block: range_from, to_block: range_to, logs });
+    }
+
+    while (next_block <= to_block && in_flight.length < concurrency) {
+        request();
+    }
+
+    while (in_flight.length) {
+        const range = in_flight.shift();
+        const logs = await range.logs;
+        if (next_block <= to_block) {
+            request();
+        }
+
+        yield { from_block: range.from_block, to_block: range.to_block, logs };
+    }
+}
+
+// Must match CHECKPOINT_MAX_BITMAP_BYTES in teleporteos
+const CHECKPOINT_MAX_BITMAP_BYTES = 32;
+
+/*
+Bitmaps with bit (id - base_id) set for every claimed teleport id, as hex for the bytes ABI type.
+Ids are split into as many bitmaps as needed so none is larger than max_bytes, each starting at its
+lowest id, so every oracle splits the same ids the same way.
+ */
+const claims_bitmaps = (ids, max_bytes = CHECKPOINT_MAX_BITMAP_BYTES) => {
+    const sorted = [...new Set(ids)].sort((a, b) => (a < b ? -1 : a > b ? 1 : 0));
+    const span = BigInt(max_bytes * 8);
+
+    const chunks = [];
+    let chunk = null;
+    for (const id of sorted) {
+        if (!chunk || id - chunk.base_id >= span) {
+            chunk = { base_id: id, bytes: [] };
+            chunks.push(chunk);
+        }
+        const bit = Number(id - chunk.base_id);
+        while (chunk.bytes.length <= bit >> 3) {
+            chunk.bytes.push(0);
+        }
+        chunk.bytes[bit >> 3] |= 1 << (bit & 7);
+    }
+
+    return chunks.map((c) => ({ base_id: c.base_id, bitmap: Buffer.from(c.bytes).toString('hex') }));
+}
+
+module.exports = {
+    claimed_topic,
+    teleport_topic,
+    decode_teleport,
+    decode_claimed,
+    log_ranges,
+    claims_bitmaps
+};
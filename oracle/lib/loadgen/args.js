@@ -0,0 +1,92 @@
+'use strict';
+
+const { parseFiniteInt } = require('../monitor/args');
+
+function parseRate(value, name) {
+  const n = Number.parseFloat(String(value).trim());
+  if (!Number.isFinite(n) || n < 0) {
+    throw new Error(`Invalid ${name}: ${JSON.stringify(value)} (expected a rate >= 0)`);
+  }
+  return n;
+}
+
+const USAGE = `Usage: CONFIG=./config.js node loadgen.js [options]
+
+Drives synthetic bridge traffic against a local single node chain and reports throughput,
+queue depth and per-stage latency.
+
+  --setup                   create load accounts and fund them before starting
+  --accounts <n>            number of load accounts (default 50)
+  --prefill <n>             insert n teleports with injecttel before starting (default 0)
+  --teleport-rate <n/s>     transfer+teleport transactions per second (default 1)
+  --received-rate <n/s>     receipts confirmed by all oracles per second (default 0)
+  --claimed-rate <n/s>      claimed() calls per second for signed teleports (default 0)
+  --sign                    sign teleports as the assigned oracles (when oracle-eos is not running)
+  --stub-evm-port <port>    serve Teleport logs for oracle-eth on this port (default off)
+  --stub-evm-logs <n>       Teleport logs per stub EVM block (default 1)
+  --stub-evm-block-time <s> seconds per stub EVM block (default 3)
+  --max-in-flight <n>       pending transactions per stage before dropping (default 50)
+  --duration <s>            stop after this many seconds (default run until killed)
+  --interval <s>            report interval (default 10)
+`;
+
+function parseArgs(argv) {
+  const args = {
+    setup: false,
+    accounts: 50,
+    prefill: 0,
+    teleportRate: 1,
+    receivedRate: 0,
+    claimedRate: 0,
+    sign: false,
+    stubEvmPort: 0,
+    stubEvmLogs: 1,
+    stubEvmBlockTime: 3,
+    maxInFlight: 50,
+    duration: 0,
+    interval: 10,
+  };
+
+  try {
+    for (let i = 2; i < argv.length; i++) {
+      const a = argv[i];
+      const next = () => {
+        const v = argv[++i];
+        if (v === undefined) throw new Error(`${a} requires a value`);
+        return v;
+      };
+
+      if (a === '--setup') args.setup = true;
+      else if (a === '--sign') args.sign = true;
+      else if (a === '--accounts') args.accounts = parseFiniteInt(next(), '--accounts', { min: 1 });
+      else if (a === '--prefill') args.prefill = parseFiniteInt(next(), '--prefill', { min: 0 });
+      else if (a === '--teleport-rate') args.teleportRate = parseRate(next(), '--teleport-rate');
+      else if (a === '--received-rate') args.receivedRate = parseRate(next(), '--received-rate');
+      else if (a === '--claimed-rate') args.claimedRate = parseRate(next(), '--claimed-rate');
+      else if (a === '--stub-evm-port')
+        args.stubEvmPort = parseFiniteInt(next(), '--stub-evm-port', { min: 1, max: 65535 });
+      else if (a === '--stub-evm-logs')
+        args.stubEvmLogs = parseFiniteInt(next(), '--stub-evm-logs', { min: 0 });
+      else if (a === '--stub-evm-block-time')
+        args.stubEvmBlockTime = parseFiniteInt(next(), '--stub-evm-block-time', { min: 1 });
+      else if (a === '--max-in-flight')
+        args.maxInFlight = parseFiniteInt(next(), '--max-in-flight', { min: 1 });
+      else if (a === '--duration') args.duration = parseFiniteInt(next(), '--duration', { min: 0 });
+      else if (a === '--interval') args.interval = parseFiniteInt(next(), '--interval', { min: 1 });
+      else if (a === '--help' || a === '-h') {
+        console.log(USAGE);
+        process.exit(0);
+      } else {
+        throw new Error(`Unknown option ${a}`);
+      }
+    }
+  } catch (e) {
+    console.error(e.message);
+    console.error(USAGE);
+    process.exit(3);
+  }
+
+  return args;
+}
+
+module.exports = { parseArgs };
@@ -0,0 +1,335 @@
+'use strict';
+
+const crypto = require('crypto');
+const { Api, JsonRpc } = require('eosjs');
+const { JsSignatureProvider } = require('eosjs/dist/eosjs-jssig');
+const { PrivateKey } = require('eosjs/dist/eosjs-key-conversions');
+const fetch = require('node-fetch');
+const { TextDecoder, TextEncoder } = require('text-encoding');
+
+// Must match ORACLE_CONFIRMATIONS and TELEPORT_SIGNATURES in teleporteos
+const ORACLE_CONFIRMATIONS = 5;
+const TELEPORT_SIGNATURES = 3;
+const NAME_CHARS = 'abcdefghijklmnopqrstuvwxyz12345';
+
+function create_chain(lg) {
+  const rpc = new JsonRpc(lg.endpoint, { fetch });
+  const signatureProvider = new JsSignatureProvider([lg.privateKey]);
+  const api = new Api({
+    rpc,
+    signatureProvider,
+    textDecoder: new TextDecoder(),
+    textEncoder: new TextEncoder(),
+  });
+  const public_key = PrivateKey.fromString(lg.privateKey).getPublicKey().toLegacyString();
+
+  const transact = (actions) => api.transact({ actions }, { blocksBehind: 3, expireSeconds: 60 });
+
+  return { rpc, api, public_key, transact };
+}
+
+function load_account(prefix, index) {
+  let suffix = '';
+  for (let i = 0; i < 4; i++) {
+    suffix = NAME_CHARS[index % NAME_CHARS.length] + suffix;
+    index = Math.floor(index / NAME_CHARS.length);
+  }
+  return `${prefix}${suffix}`;
+}
+
+function random_hex(bytes) {
+  return crypto.randomBytes(bytes).toString('hex');
+}
+
+function auth(actor) {
+  return [{ actor, permission: 'active' }];
+}
+
+/* Tracks one kind of traffic, a stage, for reporting */
+class Stage {
+  constructor(name) {
+    this.name = name;
+    this.ok = 0;
+    this.failed = 0;
+    this.dropped = 0;
+    this.in_flight = 0;
+    this.latency_ms = 0;
+    this.last_error = null;
+  }
+
+  /* fn returns false when there was nothing to send, which counts as dropped rather than failed */
+  async run(fn) {
+    this.in_flight++;
+    const t0 = Date.now();
+    try {
+      if ((await fn()) === false) {
+        this.dropped++;
+      } else {
+        this.ok++;
+        this.latency_ms += Date.now() - t0;
+      }
+    } catch (e) {
+      this.failed++;
+      this.last_error = e.message;
+    } finally {
+      this.in_flight--;
+    }
+  }
+}
+
+/* Calls fn `rate` times per second, dropping calls while max_in_flight are still pending */
+function rate_loop(stage, rate, max_in_flight, fn) {
+  if (!rate) {
+    return null;
+  }
+
+  let credit = 0;
+  return setInterval(() => {
+    credit += rate / 10;
+    while (credit >= 1) {
+      credit--;
+      if (stage.in_flight >= max_in_flight) {
+        stage.dropped++;
+        continue;
+      }
+      stage.run(fn);
+    }
+  }, 100);
+}
+
+async function batches(items, size, fn) {
+  for (let i = 0; i < items.length; i += size) {
+    await fn(items.slice(i, i + size));
+  }
+}
+
+/* Creates and funds the load accounts, existing accounts are left alone */
+async function setup_accounts(chain, lg, users) {
+  const authority = {
+    threshold: 1,
+    keys: [{ key: chain.public_key, weight: 1 }],
+    accounts: [],
+    waits: [],
+  };
+
+  const missing = [];
+  for (const user of users) {
+    try {
+      await chain.rpc.get_account(user);
+    } catch (e) {
+      missing.push(user);
+    }
+  }
+
+  await batches(missing, 20, (names) =>
+    chain.transact(
+      names.map((name) => ({
+        account: 'eosio',
+        name: 'newaccount',
+        authorization: auth('eosio'),
+        data: { creator: 'eosio', name, owner: authority, active: authority },
+      }))
+    )
+  );
+
+  await batches(users, 20, (names) =>
+    chain.transact(
+      names.map((to) => ({
+        account: lg.tokenContract,
+        name: 'transfer',
+        authorization: auth(lg.tokenIssuer),
+        data: { from: lg.tokenIssuer, to, quantity: lg.fundQuantity, memo: 'load test' },
+      }))
+    )
+  );
+
+  console.log(`Created ${missing.length} and funded ${users.length} load accounts`);
+}
+
+/* Fills the teleports table with injecttel so tests run against a realistic table size */
+async function prefill_teleports(chain, lg, users, count) {
+  const items = Array.from({ length: count }, (_, i) => i);
+  await batches(items, 50, (batch) =>
+    chain.transact(
+      batch.map((i) => ({
+        account: lg.teleportContract,
+        name: 'injecttel',
+        authorization: auth(lg.teleportContract),
+        data: {
+          from: users[i % users.length],
+          eth_address: random_hex(20) + '000000000000000000000000',
+          quantity: lg.quantity,
+          chain_id: lg.chainId,
+        },
+      }))
+    )
+  );
+
+  console.log(`Prefilled ${count} teleports`);
+}
+
+function teleport(chain, lg, users) {
+  return async () => {
+    const from = users[Math.floor(Math.random() * users.length)];
+    await chain.transact([
+      {
+        account: lg.tokenContract,
+        name: 'transfer',
+        authorization: auth(from),
+        data: { from, to: lg.teleportContract, quantity: lg.quantity, memo: '' },
+      },
+      {
+        account: lg.teleportContract,
+        name: 'teleport',
+        authorization: auth(from),
+        data: {
+          from,
+          quantity: lg.quantity,
+          chain_id: lg.chainId,
+          eth_address: random_hex(20) + '000000000000000000000000',
+        },
+      },
+    ]);
+  };
+}
+
+/* One receipt confirmed by each oracle in turn, as oracle-eth would */
+function received(chain, lg, users) {
+  return async () => {
+    const to = users[Math.floor(Math.random() * users.length)];
+    const ref = random_hex(32);
+    for (const oracle of lg.oracles.slice(0, ORACLE_CONFIRMATIONS)) {
+      await chain.transact([
+        {
+          account: lg.teleportContract,
+          name: 'received',
+          authorization: auth(oracle),
+          data: {
+            oracle_name: oracle,
+            to,
+            ref,
+            quantity: lg.quantity,
+            chain_id: lg.chainId,
+            confirmed: true,
+          },
+        },
+      ]);
+    }
+  };
+}
+
+async function fetch_recent(chain, lg, table, limit = 500) {
+  const res = await chain.rpc.get_table_rows({
+    code: lg.teleportContract,
+    scope: lg.teleportContract,
+    table,
+    reverse: true,
+    limit,
+  });
+  return res.rows;
+}
+
+/*
+Watches recent teleports and receipts to measure queue depth, signs pending teleports as the
+assigned oracles when oracle-eos is not running and queues signed teleports for claimed()
+ */
+class Pipeline {
+  constructor(chain, lg, { sign, sign_stage, max_in_flight }) {
+    this.chain = chain;
+    this.lg = lg;
+    this.sign = sign;
+    this.sign_stage = sign_stage;
+    this.max_in_flight = max_in_flight;
+    this.submitted = new Set();
+    this.claimable = [];
+    this.depth = { unsigned: 0, unclaimed: 0, incomplete_receipts: 0 };
+  }
+
+  async poll() {
+    const [teleports, receipts] = await Promise.all([
+      fetch_recent(this.chain, this.lg, 'teleports'),
+      fetch_recent(this.chain, this.lg, 'receipts'),
+    ]);
+
+    const signed = (t) => t.oracles.length + (t.signature_count || 0) >= TELEPORT_SIGNATURES;
+    const unsigned = teleports.filter((t) => !t.claimed && !signed(t));
+    const unclaimed = teleports.filter((t) => !t.claimed && signed(t));
+
+    this.depth = {
+      unsigned: unsigned.length,
+      unclaimed: unclaimed.length,
+      incomplete_receipts: receipts.filter((r) => !r.completed).length,
+    };
+    this.claimable = unclaimed.filter((t) => !this.submitted.has(`claimed:${t.id}`));
+
+    // keys are `sign:<id>:<oracle>` or `claimed:<id>`, forget teleports which left the window
+    const window_ids = new Set(teleports.map((t) => String(t.id)));
+    for (const key of this.submitted) {
+      if (!window_ids.has(key.split(':')[1])) {
+        this.submitted.delete(key);
+      }
+    }
+
+    if (this.sign) {
+      for (const t of unsigned) {
+        const assigned =
+          t.assigned_oracles && t.assigned_oracles.length ? t.assigned_oracles : this.lg.oracles;
+        for (const oracle of assigned.slice(0, TELEPORT_SIGNATURES)) {
+          const key = `sign:${t.id}:${oracle}`;
+          if (this.submitted.has(key) || this.sign_stage.in_flight >= this.max_in_flight) {
+            continue;
+          }
+          this.submitted.add(key);
+          this.sign_stage.run(() =>
+            this.chain.transact([
+              {
+                account: this.lg.teleportContract,
+                name: 'sign',
+                authorization: auth(oracle),
+                data: {
+                  oracle_name: oracle,
+                  id: t.id,
+                  signature: `load-${random_hex(8)}`,
+                  quantity: t.quantity,
+                },
+              },
+            ])
+          );
+        }
+      }
+    }
+  }
+
+  claimed() {
+    return async () => {
+      const t = this.claimable.shift();
+      if (!t) {
+        // no signed teleport waiting for a claim yet
+        return false;
+      }
+      this.submitted.add(`claimed:${t.id}`);
+
+      const oracle = this.lg.oracles[0];
+      await this.chain.transact([
+        {
+          account: this.lg.teleportContract,
+          name: 'claimed',
+          authorization: auth(oracle),
+          data: { oracle_name: oracle, id: t.id, to_eth: t.eth_address, quantity: t.quantity },
+        },
+      ]);
+    };
+  }
+}
+
+module.exports = {
+  create_chain,
+  load_account,
+  Stage,
+  rate_loop,
+  setup_accounts,
+  prefill_teleports,
+  teleport,
+  received,
+  Pipeline,
+};
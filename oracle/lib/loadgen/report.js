@@ -0,0 +1,84 @@
+'use strict';
+
+// Must match latency_bounds in teleporteos.cpp
+const LATENCY_BOUNDS = [10, 30, 60, 120, 300, 600, 1800, 3600, 7200, 21600, 86400, 604800];
+
+/* Upper bound in seconds of the bucket holding the q quantile of a latency histogram row */
+function percentile(row, q) {
+  const target = Math.ceil(row.count * q);
+  let seen = 0;
+  for (let i = 0; i < row.buckets.length; i++) {
+    seen += row.buckets[i];
+    if (seen >= target) {
+      return i < LATENCY_BOUNDS.length ? `<=${LATENCY_BOUNDS[i]}s` : `>${LATENCY_BOUNDS[LATENCY_BOUNDS.length - 1]}s`;
+    }
+  }
+  return '-';
+}
+
+async function fetchLatency(chain, lg) {
+  const res = await chain.rpc.get_table_rows({
+    code: lg.teleportContract,
+    scope: lg.teleportContract,
+    table: 'latency',
+    limit: 100,
+  });
+  return res.rows;
+}
+
+function stageLine(stage, prev, elapsedSec) {
+  const done = stage.ok - (prev ? prev.ok : 0);
+  const avg = stage.ok ? Math.round(stage.latency_ms / stage.ok) : 0;
+  return (
+    `  ${stage.name.padEnd(9)} ${(done / elapsedSec).toFixed(2).padStart(8)}/s ` +
+    `ok=${stage.ok} failed=${stage.failed} dropped=${stage.dropped} ` +
+    `in_flight=${stage.in_flight} avg_push=${avg}ms` +
+    (stage.last_error ? ` last_error="${stage.last_error}"` : '')
+  );
+}
+
+/* Returns a function printing one report and remembering the counters for the next interval */
+function reporter(chain, lg, stages, pipeline, stub_evm) {
+  let prev = {};
+  let last = Date.now();
+
+  return async () => {
+    const now = Date.now();
+    const elapsedSec = Math.max((now - last) / 1000, 0.001);
+    last = now;
+
+    console.log(`\n[${new Date(now).toISOString()}]`);
+    for (const stage of stages) {
+      console.log(stageLine(stage, prev[stage.name], elapsedSec));
+    }
+    prev = Object.fromEntries(stages.map((s) => [s.name, { ok: s.ok }]));
+
+    const d = pipeline.depth;
+    console.log(
+      `  queues    unsigned=${d.unsigned} awaiting_claim=${d.unclaimed} ` +
+        `incomplete_receipts=${d.incomplete_receipts} (last 500 rows)`
+    );
+
+    if (stub_evm) {
+      console.log(
+        `  stub-evm  head=${stub_evm.head()} requests=${stub_evm.stats.requests} ` +
+          `logs_served=${stub_evm.stats.logs_served}`
+      );
+    }
+
+    try {
+      for (const row of await fetchLatency(chain, lg)) {
+        console.log(
+          `  latency   chain=${row.chain_id} ${row.stage.padEnd(9)} n=${row.count} ` +
+            `avg=${row.count ? Math.round(row.total_seconds / row.count) : 0}s ` +
+            `p50${percentile(row, 0.5)} p90${percentile(row, 0.9)} p99${percentile(row, 0.99)} ` +
+            `max=${row.max_seconds}s`
+        );
+      }
+    } catch (e) {
+      console.log(`  latency   unavailable: ${e.message}`);
+    }
+  };
+}
+
+module.exports = { reporter, percentile };
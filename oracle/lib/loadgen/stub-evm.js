@@ -0,0 +1,131 @@
+'use strict';
+
+/*
+Minimal EVM JSON-RPC stand-in for load tests.
+
+Produces a new block every `blockTime` seconds containing `logsPerBlock` Teleport events from the
+configured teleport contract, so oracle-eth can be pointed at it to drive the received() path
+without a real EVM chain. Only the calls oracle-eth makes are implemented.
+ */
+
+const http = require('http');
+const { teleport_topic } = require('../eth-ingest');
+
+function hex(n) {
+  return `0x${BigInt(n).toString(16)}`;
+}
+
+function word(n) {
+  return BigInt(n).toString(16).padStart(64, '0');
+}
+
+// ABI encoding of the non indexed Teleport(string to, uint tokens, uint chainId) fields
+function encode_teleport(to, tokens, chain_id) {
+  const to_hex = Buffer.from(to, 'utf8').toString('hex');
+  const padded = to_hex.padEnd(Math.ceil(to_hex.length / 64) * 64, '0');
+  return `0x${word(96)}${word(tokens)}${word(chain_id)}${word(to.length)}${padded}`;
+}
+
+function start_stub_evm({
+  port,
+  address,
+  recipients,
+  logsPerBlock,
+  blockTime,
+  tokens,
+  chainId,
+  startBlock = 1000,
+}) {
+  const started = Date.now();
+  const stats = { logs_served: 0, requests: 0 };
+
+  const head = () => startBlock + Math.floor((Date.now() - started) / (blockTime * 1000));
+
+  const block_hash = (n) => `0x${word(n)}`;
+
+  const logs_for_block = (n) => {
+    const logs = [];
+    for (let i = 0; i < logsPerBlock; i++) {
+      const to = recipients[(n * logsPerBlock + i) % recipients.length];
+      logs.push({
+        address,
+        blockNumber: hex(n),
+        blockHash: block_hash(n),
+        transactionHash: `0x${word(n * 1000 + i)}`,
+        transactionIndex: hex(i),
+        logIndex: hex(i),
+        removed: false,
+        topics: [teleport_topic, `0x${word(0)}`],
+        data: encode_teleport(to, tokens, chainId),
+      });
+    }
+    return logs;
+  };
+
+  const handlers = {
+    eth_chainId: () => hex(chainId),
+    net_version: () => String(chainId),
+    eth_blockNumber: () => hex(head()),
+    eth_getBlockByNumber: ([tag]) => {
+      const n = tag === 'latest' ? head() : Number(BigInt(tag));
+      return {
+        number: hex(n),
+        hash: block_hash(n),
+        parentHash: block_hash(n - 1),
+        timestamp: hex(Math.floor(started / 1000) + (n - startBlock) * blockTime),
+        gasLimit: '0x0',
+        gasUsed: '0x0',
+        transactions: [],
+      };
+    },
+    eth_getLogs: ([filter]) => {
+      const from = Number(BigInt(filter.fromBlock));
+      const to = Math.min(Number(BigInt(filter.toBlock)), head());
+      const topics = [].concat((filter.topics || [])[0] || []);
+      if (topics.length && !topics.includes(teleport_topic)) {
+        return [];
+      }
+
+      let logs = [];
+      for (let n = Math.max(from, startBlock); n <= to; n++) {
+        logs = logs.concat(logs_for_block(n));
+      }
+      stats.logs_served += logs.length;
+      return logs;
+    },
+  };
+
+  const respond = (req) => {
+    const handler = handlers[req.method];
+    if (!handler) {
+      return {
+        jsonrpc: '2.0',
+        id: req.id,
+        error: { code: -32601, message: `Method ${req.method} not found` },
+      };
+    }
+    return { jsonrpc: '2.0', id: req.id, result: handler(req.params || []) };
+  };
+
+  const server = http.createServer((req, res) => {
+    let body = '';
+    req.on('data', (chunk) => (body += chunk));
+    req.on('end', () => {
+      stats.requests++;
+      let response;
+      try {
+        const json = JSON.parse(body);
+        response = Array.isArray(json) ? json.map(respond) : respond(json);
+      } catch (e) {
+        response = { jsonrpc: '2.0', id: null, error: { code: -32700, message: e.message } };
+      }
+      res.writeHead(200, { 'Content-Type': 'application/json' });
+      res.end(JSON.stringify(response));
+    });
+  });
+  server.listen(port);
+
+  return { server, stats, head };
+}
+
+module.exports = { start_stub_evm, encode_teleport };
@@ -3,6 +3,7 @@
 const fetch = require('node-fetch');
 const { config, rpc, ANTELOPE_CHAIN } = require('./context');
 const { collectReaders } = require('./readers');
+const { fetch_signatures } = require('../signatures');
 
 async function fetchTable(table, pages) {
   const rows = [];
@@ -45,6 +46,35 @@ async function fetchTable(table, pages) {
   return rows;
 }
 
+const SIGNER_FETCH_CONCURRENCY = 8;
+
+function signatureCount(row) {
+  return ((row.signatures && row.signatures.length) || 0) + Number(row.signature_count || 0);
+}
+
+// Only teleports still short of the threshold are reported with their signers
+async function attachSigners(rows, opts) {
+  const pending = rows.filter(
+    (row) =>
+      !(row.claimed === true || row.claimed === 1) &&
+      matchesChain(row, opts.chainId) &&
+      Number(row.signature_count || 0) > 0 &&
+      signatureCount(row) < opts.sigThreshold
+  );
+
+  let next = 0;
+  const worker = async () => {
+    while (next < pending.length) {
+      const row = pending[next++];
+      const sigs = await fetch_signatures(rpc, config.eos.teleportContract, row.id);
+      row.oracles = (row.oracles || []).concat(sigs.map((s) => s.oracle));
+    }
+  };
+  await Promise.all(
+    Array.from({ length: Math.min(SIGNER_FETCH_CONCURRENCY, pending.length) }, worker)
+  );
+}
+
 function teleportTimeSec(row) {
   if (typeof row.time === 'number') return row.time;
   if (typeof row.time === 'string' && /^\d+$/.test(row.time)) return parseInt(row.time, 10);
@@ -106,9 +136,12 @@ function analyseTeleports(rows, opts, nowSec, me) {
     const ts = teleportTimeSec(row);
     if (!isOldEnough(ts, opts.minAgeSec, nowSec)) continue;
 
-    const sigs = (row.signatures && row.signatures.length) || 0;
+    const sigs = signatureCount(row);
     const oracles = row.oracles || [];
     const iSigned = oracles.includes(me);
+    // teleports are assigned to a subset of oracles, others are not expected to sign
+    const assigned = row.assigned_oracles || [];
+    const iAssigned = !assigned.length || assigned.includes(me);
 
     if (sigs < opts.sigThreshold) {
       const item = {
@@ -125,7 +158,7 @@ function analyseTeleports(rows, opts, nowSec, me) {
         this_oracle_signed: iSigned,
       };
       systemIncomplete.push(item);
-      if (!iSigned) missingMine.push(item);
+      if (!iSigned && iAssigned) missingMine.push(item);
     } else {
       awaitingClaim.push({
         direction: 'wax_to_evm',
@@ -194,6 +227,8 @@ async function scan(opts) {
   const { live } = require('./context');
   live.last_readers_at = new Date().toISOString();
 
+  await attachSigners(teleports, opts);
+
   const t = analyseTeleports(teleports, opts, nowSec, me);
   const r = analyseReceipts(receipts, opts, nowSec, me);
 
@@ -0,0 +1,17 @@
+'use strict';
+
+// Signatures are stored one row per oracle, keyed by (teleport id << 8) | slot
+async function fetch_signatures(rpc, contract, id) {
+  const base = Number(id) * 256;
+  const res = await rpc.get_table_rows({
+    code: contract,
+    scope: contract,
+    table: 'signatures',
+    lower_bound: base,
+    upper_bound: base + 255,
+    limit: 256,
+  });
+  return res.rows || [];
+}
+
+module.exports = { fetch_signatures };
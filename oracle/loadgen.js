@@ -0,0 +1,123 @@
+#!/usr/bin/env node
+
+/**
+ * Synthetic load generator for the teleport bridge.
+ *
+ * Drives transfer+teleport, received and claimed traffic at configured rates against a local
+ * single node chain and reports throughput, queue depth and per-stage latency (from the
+ * teleporteos latency table). Optionally serves Teleport logs on a stub EVM JSON-RPC endpoint
+ * so oracle-eth can be run against it fully offline.
+ *
+ * Modules live under ./lib/loadgen/ — keep this file thin.
+ *
+ *   CONFIG=./config-local.js node loadgen.js --setup --teleport-rate 5 --sign --claimed-rate 2
+ *   CONFIG=./config-local.js node loadgen.js --stub-evm-port 8545 --stub-evm-logs 4
+ *
+ * Never point this at a public chain, the `loadgen` config section is meant for a local nodeos
+ * where one key controls eosio, the contracts, the oracles and the load accounts.
+ */
+
+'use strict';
+
+process.title = `loadgen ${process.env.CONFIG || './config'}`;
+
+const path = require('path');
+const { parseArgs } = require('./lib/loadgen/args');
+const {
+  create_chain,
+  load_account,
+  Stage,
+  rate_loop,
+  setup_accounts,
+  prefill_teleports,
+  teleport,
+  received,
+  Pipeline,
+} = require('./lib/loadgen/drivers');
+const { reporter } = require('./lib/loadgen/report');
+const { start_stub_evm } = require('./lib/loadgen/stub-evm');
+
+const config = require(path.resolve(process.env.CONFIG || './config'));
+
+async function main() {
+  const opts = parseArgs(process.argv);
+
+  const lg = {
+    tokenContract: 'alien.worlds',
+    tokenIssuer: 'alien.worlds',
+    teleportContract: config.eos.teleportContract,
+    quantity: '100.0000 TLM',
+    fundQuantity: '100000.0000 TLM',
+    userPrefix: 'loadusr',
+    chainId: Number.parseInt(config.eth.chainId),
+    ...config.loadgen,
+  };
+  if (!lg.endpoint || !lg.privateKey || !lg.oracles || !lg.oracles.length) {
+    console.error('Invalid config: need loadgen.endpoint, loadgen.privateKey and loadgen.oracles');
+    process.exit(3);
+  }
+
+  const chain = create_chain(lg);
+  const users = Array.from({ length: opts.accounts }, (_, i) => load_account(lg.userPrefix, i));
+
+  if (opts.setup) {
+    await setup_accounts(chain, lg, users);
+  }
+  if (opts.prefill) {
+    await prefill_teleports(chain, lg, users, opts.prefill);
+  }
+
+  let stub_evm = null;
+  if (opts.stubEvmPort) {
+    stub_evm = start_stub_evm({
+      port: opts.stubEvmPort,
+      address: config.eth.teleportContract,
+      recipients: users,
+      logsPerBlock: opts.stubEvmLogs,
+      blockTime: opts.stubEvmBlockTime,
+      tokens: 100_0000,
+      chainId: lg.chainId,
+    });
+    console.log(`Stub EVM endpoint listening on http://127.0.0.1:${opts.stubEvmPort}`);
+  }
+
+  const stages = {
+    teleport: new Stage('teleport'),
+    sign: new Stage('sign'),
+    received: new Stage('received'),
+    claimed: new Stage('claimed'),
+  };
+  const pipeline = new Pipeline(chain, lg, {
+    sign: opts.sign,
+    sign_stage: stages.sign,
+    max_in_flight: opts.maxInFlight,
+  });
+
+  const timers = [
+    rate_loop(stages.teleport, opts.teleportRate, opts.maxInFlight, teleport(chain, lg, users)),
+    rate_loop(stages.received, opts.receivedRate, opts.maxInFlight, received(chain, lg, users)),
+    rate_loop(stages.claimed, opts.claimedRate, opts.maxInFlight, pipeline.claimed()),
+    setInterval(() => pipeline.poll().catch((e) => console.error(`Poll failed ${e.message}`)), 1000),
+  ];
+
+  const report = reporter(chain, lg, Object.values(stages), pipeline, stub_evm);
+  timers.push(setInterval(report, opts.interval * 1000));
+
+  console.log(
+    `Load started (teleport=${opts.teleportRate}/s, received=${opts.receivedRate}/s, ` +
+      `claimed=${opts.claimedRate}/s, sign=${opts.sign}, accounts=${opts.accounts})`
+  );
+
+  if (opts.duration) {
+    setTimeout(async () => {
+      timers.filter(Boolean).forEach(clearInterval);
+      await report();
+      process.exit(0);
+    }, opts.duration * 1000);
+  }
+}
+
+main().catch((e) => {
+  console.error(e.message);
+  process.exit(3);
+});
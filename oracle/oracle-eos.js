@@ -20,6 +20,7 @@ const { fork } = require('child_process');
 
 const Web3 = require('web3');
 const ethUtil = require('ethereumjs-util');
+const { fetch_signatures } = require('./lib/signatures');
 
 // @eosdacio/eosio-statereceiver hardcodes fetch_block:true, which deserializes every
 // signed_block (including WA/WebAuthn tx signatures). This oracle only uses traces for
@@ -53,6 +54,15 @@ const eos_api = new Api({ rpc, signatureProvider, textDecoder: new TextDecoder()
 
 let tx_dispatcher = null;
 
+// Serialized size of the logteleport fields checked by the EVM claim
+const TELEPORT_DATA_LENGTH = 69;
+// Must match TELEPORT_SIGNATURES and ASSIGNMENT_TIMEOUT_SECONDS in teleporteos
+const SIGNATURE_THRESHOLD = 3;
+const ASSIGNMENT_TIMEOUT_SECONDS = 600;
+// How often and how far back the teleports table is scanned for timed out assignments
+const TIMEOUT_SCAN_INTERVAL_MS = 60 * 1000;
+const TIMEOUT_SCAN_ROWS = 500;
+
 // Durable WAX cursor (same idea as oracle-eth's .oracle_*_block files).
 // Lets the status monitor report true lag instead of 1000-block log granularity.
 const waxNetwork = config.network || 'ETH';
@@ -82,12 +92,109 @@ const save_wax_block = (block_num) => {
 
 // const ethAbi = require(`./eth_abi`);
 
+// logteleport fields as found in the teleports table, for teleports signed from a table scan
+const teleport_data = (row) => ({
+    id: row.id,
+    time: row.time,
+    from: row.account,
+    quantity: row.quantity,
+    chain_id: row.chain_id,
+    eth_address: row.eth_address,
+    oracles: row.assigned_oracles || []
+});
+
+// Serialized like the logteleport action data, only the first TELEPORT_DATA_LENGTH bytes are signed
+const serialize_teleport = (row) => {
+    const sb = new Serialize.SerialBuffer({ textEncoder: new TextEncoder(), textDecoder: new TextDecoder() });
+    sb.pushNumberAsUint64(row.id);
+    sb.pushUint32(row.time);
+    sb.pushName(row.account);
+    sb.pushAsset(row.quantity);
+    sb.push(row.chain_id & 0xff);
+    sb.pushArray(Buffer.from(row.eth_address, 'hex'));
+    return sb.asUint8Array();
+};
+
 class TraceHandler {
     constructor({ config }) {
         this.config = config;
         this.queue = [];
         this.processingQueue = false;
+        this.scanningTimeouts = false;
+        this.timeoutQueued = new Set();
         setInterval(this.processQueue.bind(this), 1000);
+        setInterval(this.scanTimedOut.bind(this), TIMEOUT_SCAN_INTERVAL_MS);
+    }
+
+    /*
+    Teleports this oracle is not assigned to are only signed once the assignment has timed out, found
+    by scanning the table rather than held in memory so they survive a restart after the WAX cursor
+    has moved past their logteleport
+     */
+    async scanTimedOut() {
+        if (this.scanningTimeouts) {
+            return;
+        }
+        this.scanningTimeouts = true;
+
+        try {
+            const me = config.eos.oracleAccount;
+            const now = Math.floor(Date.now() / 1000);
+            const in_window = new Set();
+            let upper_bound;
+            for (let scanned = 0; scanned < TIMEOUT_SCAN_ROWS;) {
+                const res = await rpc.get_table_rows({
+                    code: config.eos.teleportContract,
+                    scope: config.eos.teleportContract,
+                    table: 'teleports',
+                    upper_bound,
+                    reverse: true,
+                    limit: 100
+                });
+                scanned += res.rows.length;
+
+                for (const row of res.rows) {
+                    in_window.add(row.id);
+                    const assigned = row.assigned_oracles || [];
+                    const signatures = row.oracles.length + (row.signature_count || 0);
+                    if (row.claimed || !assigned.length || assigned.includes(me) || row.oracles.includes(me) ||
+                        signatures >= SIGNATURE_THRESHOLD || row.time + ASSIGNMENT_TIMEOUT_SECONDS > now ||
+                        this.timeoutQueued.has(row.id)) {
+                        continue;
+                    }
+
+                    const signed = await fetch_signatures(rpc, config.eos.teleportContract, row.id);
+                    if (signed.some((s) => s.oracle === me)) {
+                        continue;
+                    }
+
+                    console.log(`TeleportId: ${row.id}; Assignment timed out with ${signatures} signatures`);
+                    this.timeoutQueued.add(row.id);
+                    this.queue.push({ data: teleport_data(row), data_serialized: serialize_teleport(row), retries: 0 });
+                }
+
+                if (!res.more || !res.rows.length) {
+                    break;
+                }
+                const last = res.rows[res.rows.length - 1].id;
+                if (!last) {
+                    break;
+                }
+                upper_bound = last - 1;
+            }
+
+            // forget teleports which have left the scanned window
+            for (const id of this.timeoutQueued) {
+                if (!in_window.has(id)) {
+                    this.timeoutQueued.delete(id);
+                }
+            }
+        }
+        catch (e) {
+            console.error(`Error scanning for timed out teleports ${e.message}`);
+        }
+
+        this.scanningTimeouts = false;
     }
 
     async processQueue() {
@@ -127,9 +234,33 @@ class TraceHandler {
             }
             const chain_data = teleport_res.rows[0];
 
+            // Teleports from accounts which opted in to coalescing can be merged and logged again
+            // before they are signed, only sign data which still matches the table
+            if (chain_data.quantity !== data.quantity) {
+                console.log(`TeleportId: ${data.id}; Superseded by merged quantity ${chain_data.quantity}`);
+                this.processingQueue = false;
+                return;
+            }
+
+            // Teleports are assigned to a subset of the oracles, others only sign once the assignment
+            // has timed out and the teleport still needs signatures, scanTimedOut queues them again then
+            const assigned = data.oracles || [];
+            if (assigned.length && !assigned.includes(config.eos.oracleAccount)) {
+                if (chain_data.time + ASSIGNMENT_TIMEOUT_SECONDS > Date.now() / 1000) {
+                    console.log(`TeleportId: ${data.id}; Not assigned, left for the timeout scan`);
+                    this.processingQueue = false;
+                    return;
+                }
+                if (chain_data.oracles.length + (chain_data.signature_count || 0) >= SIGNATURE_THRESHOLD) {
+                    console.log(`TeleportId: ${data.id}; Not assigned and already has enough signatures`);
+                    this.processingQueue = false;
+                    return;
+                }
+            }
 
-            // sign the transaction and send to the eos chain
-            const data_buf = Buffer.from(data_serialized);
+            // sign the transaction and send to the eos chain, only the fixed size teleport data is
+            // signed, not the oracle assignment logged after it
+            const data_buf = Buffer.from(data_serialized).slice(0, TELEPORT_DATA_LENGTH);
             const msg_hash = ethUtil.keccak(data_buf);
             console.log(msg_hash.toString('hex'));
             // console.log(this.config.eth.privateKey);
@@ -150,7 +281,9 @@ class TraceHandler {
                 data: {
                     oracle_name: config.eos.oracleAccount,
                     id: data.id,
-                    signature
+                    signature,
+                    // the contract rejects the signature if the teleport was merged since
+                    quantity: data.quantity
                 }
             }];
 
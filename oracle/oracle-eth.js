@@ -14,6 +14,7 @@ const { JsSignatureProvider } = require('eosjs/dist/eosjs-jssig');
 const fetch = require('node-fetch');
 const fs = require('fs');
 const ethers = require('ethers');
+const { claimed_topic, teleport_topic, decode_claimed, decode_teleport, log_ranges, claims_bitmaps } = require('./lib/eth-ingest');
 
 const config = require(process.env['CONFIG'] || './config');
 
@@ -27,8 +28,13 @@ const network = config.network || 'ETH'
 const blocks_file = `.oracle_${config.network}_block-${config.eth.oracleAccount}`;
 const chain_id = Number.parseInt(config.eth.chainId);
 const DEFAULT_BLOCKS_TO_WAIT = 5;
-const claimed_topic = '0xf20fc6923b8057dd0c3b606483fcaa038229bb36ebc35a0040e3eaa39cf97b17';
-const teleport_topic = '0x622824274e0937ee319b036740cd0887131781bc2032b47eac3e88a1be17f5d5';
+const DEFAULT_LOG_RANGE = 100;
+const DEFAULT_LOG_CONCURRENCY = 4;
+const blocks_to_wait = config.eth.blocksToWait || DEFAULT_BLOCKS_TO_WAIT;
+const log_range = config.eth.logRange || DEFAULT_LOG_RANGE;
+const log_concurrency = config.eth.logConcurrency || DEFAULT_LOG_CONCURRENCY;
+// report claims as one checkpoint per logRange block window instead of one claimed action each
+const claim_checkpoints = !!config.eth.claimCheckpoints;
 
 const sleep = async (ms) => {
     return new Promise(resolve => {
@@ -36,22 +42,6 @@ const sleep = async (ms) => {
     })
 }
 
-const await_confirmation = async (txid) => {
-    return new Promise(async resolve => {
-        let resolved = false;
-        while (!resolved) {
-            provider.getTransactionReceipt(txid).then(receipt => {
-                if (receipt && receipt.confirmations > DEFAULT_BLOCKS_TO_WAIT) {
-                    console.log(`TX ${txid} has ${receipt.confirmations} confirmations`);
-                    resolve(receipt);
-                    resolved = true;
-                }
-            });
-            await sleep(10000);
-        }
-    });
-}
-
 const load_block = async () => {
     let block_number = 'latest';
     if (fs.existsSync(blocks_file)) {
@@ -74,160 +64,229 @@ const save_block = async (block_num) => {
     await fs.writeFileSync(blocks_file, block_num.toString());
 }
 
-const process_claimed = async (from_block, to_block) => {
-    return new Promise(async (resolve, reject) => {
-        try {
-            const query = {
-                fromBlock: from_block,
-                toBlock: to_block,
-                address: config.eth.teleportContract,
-                topics: [claimed_topic]
-            };
-            // console.log(query);
-            const res = await provider.getLogs(query);
-            // console.log(res);
-            if (res.length) {
-                for (let r = 0; r < res.length; r++) {
-                    const data = await ethers.utils.defaultAbiCoder.decode(['uint64', 'address', 'uint'], res[r].data);
-
-                    // console.log(res[r], data, data[1].toString());
-                    const id = data[0].toNumber();
-                    const to_eth = data[1].replace('0x', '') + '000000000000000000000000';
-                    const quantity = (data[2].toNumber() / Math.pow(10, config.precision)).toFixed(config.precision) + ' ' + config.symbol;
-                    const actions = [];
-                    actions.push({
-                        account: config.eos.teleportContract,
-                        name: 'claimed',
-                        authorization: [{
-                            actor: config.eos.oracleAccount,
-                            permission: config.eos.oraclePermission || 'active'
-                        }],
-                        data: {
-                            oracle_name: config.eos.oracleAccount,
-                            id,
-                            to_eth,
-                            quantity
-                        }
-                    });
-                    // console.log(actions, res[r].transactionHash);
-
-                    await_confirmation(res[r].transactionHash).then(async () => {
-                        try {
-                            const eos_res = await eos_api.transact({ actions }, {
-                                blocksBehind: 3,
-                                expireSeconds: 180,
-                            });
-                            console.log(`Sent notification of claim with txid ${eos_res.transaction_id}, for ID ${id}, account 0x${to_eth.substr(0, 40)}, quantity ${quantity}`);
-                            // resolve();
-                        }
-                        catch (e) {
-                            if (e.message.indexOf('Already marked as claimed') > -1) {
-                                console.log(`ID ${id} is already claimed, account 0x${to_eth.substr(0, 40)}, quantity ${quantity}`);
-                            }
-                            else {
-                                console.error(`Error sending confirm ${e.message}`);
-                                // reject(e);
-                            }
-                        }
-                    });
-
-                    await sleep(500);
-                }
-            }
+const format_quantity = (tokens) => {
+    const amount = (Number(tokens) / Math.pow(10, config.precision)).toFixed(config.precision);
+    return `${amount} ${config.symbol}`;
+}
 
-            resolve();
+const claimed_action = (log) => {
+    const data = decode_claimed(log.data);
+
+    const id = Number(data.id);
+    const to_eth = data.to.replace('0x', '') + '000000000000000000000000';
+    const quantity = format_quantity(data.tokens);
+
+    return {
+        account: config.eos.teleportContract,
+        name: 'claimed',
+        authorization: [{
+            actor: config.eos.oracleAccount,
+            permission: config.eos.oraclePermission || 'active'
+        }],
+        data: {
+            oracle_name: config.eos.oracleAccount,
+            id,
+            to_eth,
+            quantity
         }
-        catch (e) {
-            reject(e);
+    };
+}
+
+const received_action = (log) => {
+    const data = decode_teleport(log.data);
+
+    if (data.tokens <= 0n) {
+        console.error('Tokens are less than or equal to 0');
+        return null;
+    }
+    const txid = log.transactionHash.replace(/^0x/, '');
+
+    return {
+        account: config.eos.teleportContract,
+        name: 'received',
+        authorization: [{
+            actor: config.eos.oracleAccount,
+            permission: config.eos.oraclePermission || 'active'
+        }],
+        data: {
+            oracle_name: config.eos.oracleAccount,
+            to: data.to,
+            ref: txid,
+            quantity: format_quantity(data.tokens),
+            chain_id,
+            confirmed: true
         }
-    });
+    };
+}
+
+const send_action = async (action) => {
+    try {
+        const eos_res = await eos_api.transact({ actions: [action] }, {
+            blocksBehind: 3,
+            expireSeconds: 180,
+        });
+        if (action.name === 'claimed') {
+            const { id, to_eth, quantity } = action.data;
+            console.log(`Sent notification of claim with txid ${eos_res.transaction_id}, for ID ${id}, account 0x${to_eth.substr(0, 40)}, quantity ${quantity}`);
+        }
+        else {
+            console.log(`Sent notification of teleport with txid ${eos_res.transaction_id}`);
+        }
+    }
+    catch (e) {
+        if (e.message.indexOf('Already marked as claimed') > -1) {
+            const { id, to_eth, quantity } = action.data;
+            console.log(`ID ${id} is already claimed, account 0x${to_eth.substr(0, 40)}, quantity ${quantity}`);
+        }
+        else if (e.message.indexOf('Oracle has already approved') > -1) {
+            console.log('Oracle has already approved');
+        }
+        else {
+            console.error(`Error sending ${action.name} ${e.message}`);
+        }
+    }
+}
+
+// claimed teleport ids seen in the current checkpoint window
+let window_claims = new Set();
+
+const SWEEP_ROWS = 50;
+// Must match TELEPORT_SIGNATURES in teleporteos
+const CHECKPOINT_QUORUM = 3;
+// Any oracle sweeps a checkpoint its chosen sweeper has left for this long
+const SWEEP_TAKEOVER_SECONDS = 600;
+
+const oracle_action = (name, data) => {
+    return {
+        account: config.eos.teleportContract,
+        name,
+        authorization: [{
+            actor: config.eos.oracleAccount,
+            permission: config.eos.oraclePermission || 'active'
+        }],
+        data
+    };
 }
 
-const process_teleported = async (from_block, to_block) => {
-    return new Promise(async (resolve, reject) => {
+/*
+Marks teleports covered by checkpoints which reached quorum as claimed. Each checkpoint is swept by
+one of its first quorum oracles, picked by checkpoint id, so oracles do not race each other
+ */
+const sweep_checkpoints = async () => {
+    const res = await rpc.get_table_rows({
+        code: config.eos.teleportContract,
+        scope: config.eos.teleportContract,
+        table: 'checkpoints',
+        limit: 100
+    });
+
+    const now = Math.floor(Date.now() / 1000);
+    for (const checkpoint of res.rows) {
+        // bitmap is hex, so 4 bits per character
+        if (checkpoint.oracles.length < CHECKPOINT_QUORUM || checkpoint.swept >= checkpoint.bitmap.length * 4) {
+            continue;
+        }
+        const sweeper = checkpoint.oracles[Number(checkpoint.id) % CHECKPOINT_QUORUM];
+        if (sweeper !== config.eos.oracleAccount && now < checkpoint.time + SWEEP_TAKEOVER_SECONDS) {
+            continue;
+        }
+
         try {
-            const query = {
-                fromBlock: from_block,
-                toBlock: to_block,
-                address: config.eth.teleportContract,
-                topics: [teleport_topic]
-            };
-            // console.log(query);
-            const res = await provider.getLogs(query);
-            // console.log(res);
-            if (res.length) {
-                for (let r = 0; r < res.length; r++) {
-                    const data = ethers.utils.defaultAbiCoder.decode(['string', 'uint', 'uint'], res[r].data);
-
-                    // console.log(res[r], data, data[1].toString())
-
-                    const tokens = data[1].toNumber();
-                    if (tokens <= 0) {
-                        // console.error(data);
-                        console.error('Tokens are less than or equal to 0');
-                        continue;
-                    }
-                    const to = data[0];
-                    const amount = (tokens / Math.pow(10, config.precision)).toFixed(config.precision);
-                    const quantity = `${amount} ${config.symbol}`
-                    const txid = res[r].transactionHash.replace(/^0x/, '');
-
-                    const actions = [];
-                    actions.push({
-                        account: config.eos.teleportContract,
-                        name: 'received',
-                        authorization: [{
-                            actor: config.eos.oracleAccount,
-                            permission: config.eos.oraclePermission || 'active'
-                        }],
-                        data: {
-                            oracle_name: config.eos.oracleAccount,
-                            to,
-                            ref: txid,
-                            quantity,
-                            chain_id,
-                            confirmed: true
-                        }
-                    });
-                    // console.log(actions);
-
-                    await_confirmation(res[r].transactionHash).then(async () => {
-                        try {
-                            const eos_res = await eos_api.transact({ actions }, {
-                                blocksBehind: 3,
-                                expireSeconds: 180,
-                            });
-                            console.log(`Sent notification of teleport with txid ${eos_res.transaction_id}`);
-                            // resolve();
-                        }
-                        catch (e) {
-                            if (e.message.indexOf('Oracle has already approved') > -1) {
-                                console.log('Oracle has already approved');
-                            }
-                            else {
-                                console.error(`Error sending teleport ${e.message}`);
-                                // reject(e);
-                            }
-                        }
-                    });
-
-                    await sleep(500);
-                }
+            const eos_res = await eos_api.transact({
+                actions: [oracle_action('sweepclaims', { checkpoint_id: checkpoint.id, max_rows: SWEEP_ROWS })]
+            }, {
+                blocksBehind: 3,
+                expireSeconds: 180,
+            });
+            console.log(`Swept checkpoint ${checkpoint.id} with txid ${eos_res.transaction_id}`);
+        }
+        catch (e) {
+            if (e.message.indexOf('Checkpoint is already swept') > -1) {
+                console.log(`Checkpoint ${checkpoint.id} already swept`);
             }
+            else {
+                console.error(`Error sweeping checkpoint ${checkpoint.id} ${e.message}`);
+            }
+        }
+    }
+}
+
+const send_checkpoint = async (from_block, to_block) => {
+    if (!window_claims.size) {
+        return;
+    }
 
-            resolve();
+    for (const { base_id, bitmap } of claims_bitmaps(window_claims)) {
+        const action = oracle_action('claimckpt', {
+            oracle_name: config.eos.oracleAccount,
+            chain_id,
+            from_block,
+            to_block,
+            base_id: base_id.toString(),
+            bitmap
+        });
+
+        try {
+            const eos_res = await eos_api.transact({ actions: [action] }, {
+                blocksBehind: 3,
+                expireSeconds: 180,
+            });
+            console.log(`Sent checkpoint from id ${base_id} for blocks ${from_block}-${to_block} with txid ${eos_res.transaction_id}`);
         }
         catch (e) {
-            reject(e);
+            if (e.message.indexOf('Oracle has already submitted checkpoint') > -1) {
+                console.log(`Checkpoint from id ${base_id} for blocks ${from_block}-${to_block} already submitted`);
+            }
+            else {
+                console.error(`Error sending checkpoint ${e.message}`);
+            }
         }
-    })
+    }
+    window_claims = new Set();
+
+    try {
+        await sweep_checkpoints();
+    }
+    catch (e) {
+        console.error(`Error reading checkpoints ${e.message}`);
+    }
+}
+
+const process_logs = async (range) => {
+    for (const log of range.logs) {
+        if (log.removed) {
+            continue;
+        }
+
+        if (claim_checkpoints && log.topics[0] === claimed_topic) {
+            window_claims.add(decode_claimed(log.data).id);
+            continue;
+        }
+
+        const action = (log.topics[0] === claimed_topic) ? claimed_action(log) : received_action(log);
+        if (action) {
+            await send_action(action);
+        }
+    }
+
+    // ranges are aligned to logRange, so a range ending on the boundary completes the window
+    if (claim_checkpoints && (range.to_block + 1) % log_range === 0) {
+        await send_checkpoint(range.to_block + 1 - log_range, range.to_block);
+    }
 }
 
 const run = async (from_block = 'latest') => {
+    const query = {
+        address: config.eth.teleportContract,
+        topics: [[claimed_topic, teleport_topic]]
+    };
+    let window_aligned = false;
+
     while (true) {
         try {
-            const block = await provider.getBlock('latest');
-            const latest_block = block.number;
+            const latest_block = await provider.getBlockNumber();
+            // only read blocks which already have enough confirmations
+            const safe_block = latest_block - blocks_to_wait;
 
             if (from_block === 'latest') {
                 // load last seen block from file
@@ -238,35 +297,36 @@ const run = async (from_block = 'latest') => {
             }
             if (from_block === 'latest') {
                 // could not get block from file and it wasn't specified (go back 100 blocks)
-                from_block = latest_block - 100;
-                // console.log(block, from_block)
+                from_block = safe_block - 100;
+            }
+            if (claim_checkpoints && !window_aligned) {
+                // checkpoints must cover whole windows so every oracle submits the same one
+                from_block -= from_block % log_range;
+                window_aligned = true;
             }
-            let to_block = Math.min(from_block + 100, latest_block)
 
-            if (from_block >= latest_block) {
-                console.log(`Up to date at block ${to_block}`);
+            if (from_block > safe_block) {
+                console.log(`Up to date at block ${safe_block}`);
                 await sleep(10000);
+                continue;
             }
-            console.log(`Getting events from block ${from_block} to ${to_block}`)
+            console.log(`Getting events from block ${from_block} to ${safe_block}`)
 
-            await process_claimed(from_block, to_block);
-            await process_teleported(from_block, to_block);
+            for await (const range of log_ranges(provider, query, from_block, safe_block, log_range, log_concurrency)) {
+                await process_logs(range);
 
-            from_block = to_block;
+                from_block = range.to_block + 1;
 
-            // save last block received
-            await save_block(to_block);
-
-            if (latest_block - from_block <= 1000) {
-                console.log('Waiting...');
-                await sleep(30000);
-            }
-            else {
-                console.log(`Not waiting... ${latest_block} - ${from_block}`);
+                // save last block received
+                await save_block(range.to_block);
             }
+
+            console.log('Waiting...');
+            await sleep(30000);
         }
         catch (e) {
             console.error(e.message);
+            await sleep(5000);
         }
     }
 }
@@ -0,0 +1,115 @@
+'use strict';
+
+/*
+Replays synthetic TeleportToken logs (4 decimal amounts, made up hashes) through a local JSON-RPC
+stand-in and checks the hand written decoders against ethers' ABI decoder, and the ordering and
+alignment of log_ranges.
+
+  npm test
+ */
+
+const test = require('node:test');
+const assert = require('node:assert');
+const ethers = require('ethers');
+const { start_replay_rpc } = require('./replay-rpc');
+const {
+  claimed_topic,
+  teleport_topic,
+  decode_claimed,
+  decode_teleport,
+  log_ranges,
+  claims_bitmaps,
+} = require('../lib/eth-ingest');
+const fixture = require('./fixtures/teleport-logs.json');
+
+const coder = ethers.utils.defaultAbiCoder;
+const teleport_logs = fixture.logs.filter((log) => log.topics[0] === teleport_topic);
+const claimed_logs = fixture.logs.filter((log) => log.topics[0] === claimed_topic);
+
+test('decode_teleport matches the ABI decoder', () => {
+  assert.ok(teleport_logs.length);
+  for (const log of teleport_logs) {
+    const [to, tokens, chain_id] = coder.decode(['string', 'uint256', 'uint256'], log.data);
+    assert.deepStrictEqual(decode_teleport(log.data), {
+      to,
+      tokens: tokens.toBigInt(),
+      chain_id: chain_id.toBigInt(),
+    });
+  }
+});
+
+test('decode_claimed matches the ABI decoder', () => {
+  assert.ok(claimed_logs.length);
+  for (const log of claimed_logs) {
+    const [id, to, tokens] = coder.decode(['uint64', 'address', 'uint256'], log.data);
+    const decoded = decode_claimed(log.data);
+    assert.strictEqual(decoded.id, id.toBigInt());
+    assert.strictEqual(ethers.utils.getAddress(decoded.to), to);
+    assert.strictEqual(decoded.tokens, tokens.toBigInt());
+  }
+});
+
+test('log_ranges yields every fixture log once in block order over aligned ranges', async () => {
+  const rpc = await start_replay_rpc({ logs: fixture.logs, head: Number(BigInt(fixture.head)) });
+  try {
+    const provider = new ethers.providers.StaticJsonRpcProvider(rpc.url);
+    const query = { address: fixture.logs[0].address, topics: [[claimed_topic, teleport_topic]] };
+
+    const ranges = [];
+    for await (const range of log_ranges(provider, query, 37, 95, 10, 3)) {
+      ranges.push(range);
+    }
+
+    assert.deepStrictEqual(
+      ranges.map((r) => [r.from_block, r.to_block]),
+      [[37, 39], [40, 49], [50, 59], [60, 69], [70, 79], [80, 89], [90, 95]]
+    );
+
+    const logs = ranges.flatMap((r) => r.logs);
+    assert.deepStrictEqual(
+      logs.map((log) => [log.blockNumber, log.logIndex, log.data]),
+      fixture.logs.map((log) => [Number(BigInt(log.blockNumber)), Number(BigInt(log.logIndex)), log.data])
+    );
+    for (const range of ranges) {
+      assert.ok(range.logs.every((log) => log.blockNumber >= range.from_block && log.blockNumber <= range.to_block));
+    }
+  } finally {
+    rpc.server.close();
+  }
+});
+
+test('log_ranges raises a failed range in order', async () => {
+  let calls = 0;
+  const provider = {
+    getLogs: async ({ fromBlock }) => {
+      calls++;
+      if (fromBlock === 10) throw new Error('range failed');
+      return [];
+    },
+  };
+
+  const seen = [];
+  await assert.rejects(async () => {
+    for await (const range of log_ranges(provider, {}, 0, 29, 10, 3)) {
+      seen.push(range.from_block);
+    }
+  }, /range failed/);
+  assert.deepStrictEqual(seen, [0]);
+  assert.strictEqual(calls, 3);
+});
+
+test('claims_bitmaps sets one bit per id from the lowest id', () => {
+  assert.deepStrictEqual(claims_bitmaps([5n, 2n, 12n, 2n]), [{ base_id: 2n, bitmap: '0904' }]);
+});
+
+test('claims_bitmaps splits sparse ids into bounded bitmaps', () => {
+  // 32 bytes from id 1 reach id 256, so 257 starts the next bitmap
+  assert.deepStrictEqual(claims_bitmaps([1n, 800000n, 257n, 258n]), [
+    { base_id: 1n, bitmap: '01' },
+    { base_id: 257n, bitmap: '03' },
+    { base_id: 800000n, bitmap: '01' },
+  ]);
+  const widest = claims_bitmaps([1n, 256n]);
+  assert.strictEqual(widest.length, 1);
+  assert.strictEqual(widest[0].bitmap.length / 2, 32);
+});
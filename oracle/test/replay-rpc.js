@@ -0,0 +1,66 @@
+'use strict';
+
+/*
+EVM JSON-RPC stand-in which serves a fixed set of logs, for testing the log ingestion without a node.
+
+Only the calls an ethers JsonRpcProvider needs for getBlockNumber and getLogs are implemented.
+Every request is recorded in `requests` so tests can check how ranges were fetched.
+ */
+
+const http = require('http');
+
+const hex = (n) => `0x${n.toString(16)}`;
+
+function start_replay_rpc({ logs, head, chainId = 1 }) {
+  const requests = [];
+
+  const matches = (log, filter) => {
+    const block = Number(BigInt(log.blockNumber));
+    if (block < Number(BigInt(filter.fromBlock)) || block > Number(BigInt(filter.toBlock))) {
+      return false;
+    }
+    if (filter.address && filter.address.toLowerCase() !== log.address.toLowerCase()) {
+      return false;
+    }
+    // each topic position is null (any), a topic or a list of alternatives
+    return (filter.topics || []).every((topic, i) => {
+      if (topic === null) return true;
+      return [].concat(topic).includes(log.topics[i]);
+    });
+  };
+
+  const handlers = {
+    eth_chainId: () => hex(chainId),
+    net_version: () => String(chainId),
+    eth_blockNumber: () => hex(head),
+    eth_getLogs: ([filter]) => logs.filter((log) => matches(log, filter)),
+  };
+
+  const respond = (req) => {
+    requests.push(req);
+    const handler = handlers[req.method];
+    if (!handler) {
+      return { jsonrpc: '2.0', id: req.id, error: { code: -32601, message: `Method ${req.method} not found` } };
+    }
+    return { jsonrpc: '2.0', id: req.id, result: handler(req.params || []) };
+  };
+
+  const server = http.createServer((req, res) => {
+    let body = '';
+    req.on('data', (chunk) => (body += chunk));
+    req.on('end', () => {
+      const json = JSON.parse(body);
+      const response = Array.isArray(json) ? json.map(respond) : respond(json);
+      res.writeHead(200, { 'Content-Type': 'application/json' });
+      res.end(JSON.stringify(response));
+    });
+  });
+
+  return new Promise((resolve) => {
+    server.listen(0, '127.0.0.1', () => {
+      resolve({ server, requests, url: `http://127.0.0.1:${server.address().port}` });
+    });
+  });
+}
+
+module.exports = { start_replay_rpc };
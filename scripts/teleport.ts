@@ -16,6 +16,20 @@ export class Teleport {
         this.rpc = new JsonRpc('https://wax.eosdac.io', {fetch});
     }
 
+    // signatures are stored one row per oracle, keyed by (teleport id << 8) | slot
+    async getSignatures(teleportId) {
+        const base = Number(teleportId) * 256;
+        const res = await this.rpc.get_table_rows({
+            code: 'other.worlds',
+            scope: 'other.worlds',
+            table: 'signatures',
+            lower_bound: base,
+            upper_bound: base + 255,
+            limit: 256
+        });
+        return res.rows.map(r => r.signature);
+    }
+
     async getSignData(teleportId) {
         const res = await this.rpc.get_table_rows({
             code: 'other.worlds',
@@ -33,6 +47,8 @@ export class Teleport {
         const teleportData = res.rows[0];
         console.log(teleportData);
 
+        const signatures = teleportData.signatures.concat(await this.getSignatures(teleportId));
+
         // logteleport(uint64_t id, uint32_t timestamp, name from, asset quantity, uint8_t chain_id, checksum256 eth_address)
         const sb = new Serialize.SerialBuffer({
             textEncoder: new TextEncoder,
@@ -48,7 +64,7 @@ export class Teleport {
         return {
             claimAccount: '0x' + teleportData.eth_address,
             data: '0x' + toHexString(sb.array.slice(0, 69)),
-            signatures: teleportData.signatures
+            signatures
         };
     }
 }
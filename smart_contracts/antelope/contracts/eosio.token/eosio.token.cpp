@@ -124,6 +124,28 @@ void token::transfer(const name &from,
    add_balance(to, quantity, payer);
 }
 
+int64_t token::get_locked(const name &owner, const symbol_code &sym_code)
+{
+    vestings vesting_table(get_self(), get_self().value);
+    auto vest = vesting_table.find(owner.value);
+    if (vest == vesting_table.end() || vest->vesting_quantity.symbol.code().raw() != sym_code.raw()){
+        return 0;
+    }
+
+    // check we are beyond vesting start (no vesting possible before then)
+    uint32_t time_now = current_time_point().sec_since_epoch();
+    uint32_t vesting_seconds = 0;
+    if (time_now >= vest->vesting_start.sec_since_epoch()){
+        vesting_seconds = time_now - vest->vesting_start.sec_since_epoch();
+    }
+    uint64_t vest_per_second_sats = (vest->vesting_quantity.amount * 10'000) / vest->vesting_length;
+    uint64_t vested_total = (vesting_seconds * vest_per_second_sats) / 10'000; // amount they can withdraw
+    if (vested_total < vest->vesting_quantity.amount){
+        return vest->vesting_quantity.amount - vested_total;
+    }
+    return 0;
+}
+
 void token::sub_balance(const name &owner, const asset &value)
 {
     accounts from_acnts(get_self(), owner.value);
@@ -133,26 +155,9 @@ void token::sub_balance(const name &owner, const asset &value)
 
     auto remaining_balance = from.balance.amount - value.amount;
     // Check vesting if applicable
-    vestings vesting_table(get_self(), get_self().value);
-    auto vest = vesting_table.find(owner.value);
-    if (vest != vesting_table.end() && vest->vesting_quantity.symbol.code().raw() == value.symbol.code().raw()){
-        // check we are beyond vesting start (no vesting possible before then)
-        uint32_t time_now = current_time_point().sec_since_epoch();
-        uint32_t vesting_seconds = 0;
-        if (time_now >= vest->vesting_start.sec_since_epoch()){
-            vesting_seconds = time_now - vest->vesting_start.sec_since_epoch();
-        }
-//        print("\nvesting seconds ", vesting_seconds);
-        uint64_t vest_per_second_sats = (vest->vesting_quantity.amount * 10'000) / vest->vesting_length;
-//        print("\nvest_per_second_sats ", vest_per_second_sats);
-        uint64_t vested_total = (vesting_seconds * vest_per_second_sats) / 10'000; // amount they can withdraw
-//        print("\nvested_total ", vested_total);
-        if (vested_total < vest->vesting_quantity.amount){
-            uint64_t min_balance = vest->vesting_quantity.amount - vested_total;
-//            print("\nmin_balance ", min_balance);
-//            print("\ncurrent balance ", from.balance.amount);
-            check(remaining_balance >= min_balance, "Cannot transfer this amount due to vesting locks");
-        }
+    int64_t min_balance = get_locked(owner, value.symbol.code());
+    if (min_balance > 0){
+        check(remaining_balance >= min_balance, "Cannot transfer this amount due to vesting locks");
     }
 
     from_acnts.modify(from, owner, [&](auto &a) {
@@ -232,6 +237,28 @@ void token::addvesting(const name &account, const time_point_sec &vesting_start,
     }
 
 }
+
+std::vector<token::balance_info> token::getbalances(const std::vector<name> &owners, const symbol_code &sym_code)
+{
+    stats statstable(get_self(), sym_code.raw());
+    const auto &st = statstable.get(sym_code.raw(), "symbol does not exist");
+
+    std::vector<balance_info> balances;
+    balances.reserve(owners.size());
+    for (const auto &owner : owners){
+        accounts acnts(get_self(), owner.value);
+        auto ac = acnts.find(sym_code.raw());
+
+        balance_info info;
+        info.account = owner;
+        info.balance = ac == acnts.end() ? asset{0, st.supply.symbol} : ac->balance;
+        info.locked = asset{get_locked(owner, sym_code), st.supply.symbol};
+        balances.push_back(info);
+    }
+
+    return balances;
+}
+
 /*void token::clearvesting()
 {
     require_auth(get_self());
@@ -32,6 +32,21 @@ class[[eosio::contract("eosio.token")]] token : public contract
 public:
    using contract::contract;
 
+   /**
+          * Balance info.
+          *
+          * @details Returned by `getbalances`, `locked` is the part of `balance` which is still
+          * held back by a vesting schedule.
+          */
+   struct balance_info
+   {
+      name account;
+      asset balance;
+      asset locked;
+
+      EOSLIB_SERIALIZE(balance_info, (account)(balance)(locked))
+   };
+
    /**
           * Create action.
           *
@@ -120,6 +135,20 @@ public:
     ACTION addvesting(const name &account, const time_point_sec &vesting_start, const uint32_t &vesting_length, const asset &vesting_quantity);
 //    ACTION clearvesting();
 
+   /**
+          * Get balances action.
+          *
+          * @details Returns the balance and currently locked vesting amount for token `sym_code` of
+          * every account in `owners` as an action return value, so many balances can be fetched with
+          * a single call. It does not modify any tables but is a regular action, so it has to be pushed
+          * in a transaction and needs the ACTION_RETURN_VALUE protocol feature. Accounts without a
+          * balance row are returned with a zero balance.
+          *
+          * @param owners - the accounts to return balances for,
+          * @param sym_code - the token for which balances are returned.
+          */
+   [[eosio::action]] std::vector<balance_info> getbalances(const std::vector<name> &owners, const symbol_code &sym_code);
+
    /**
           * Get supply method.
           *
@@ -160,6 +189,7 @@ public:
    using open_action = eosio::action_wrapper<"open"_n, &token::open>;
    using close_action = eosio::action_wrapper<"close"_n, &token::close>;
    using addvesting_action = eosio::action_wrapper<"addvesting"_n, &token::addvesting>;
+   using getbalances_action = eosio::action_wrapper<"getbalances"_n, &token::getbalances>;
 
 private:
    TABLE account
@@ -192,6 +222,7 @@ private:
    typedef eosio::multi_index<"stat"_n, currency_stats> stats;
    typedef eosio::multi_index<"vestings"_n, vesting_item> vestings;
 
+   int64_t get_locked(const name &owner, const symbol_code &sym_code);
    void sub_balance(const name &owner, const asset &value);
    void add_balance(const name &owner, const asset &value, const name &ram_payer);
 };
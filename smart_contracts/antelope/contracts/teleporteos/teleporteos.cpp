@@ -2,12 +2,22 @@
 
 using namespace alienworlds;
 
+/* Upper bounds in seconds of the latency histogram buckets */
+static const uint32_t latency_bounds[] = {
+    10, 30, 60, 120, 300, 600, 1800, 3600, 7200, 21600, 86400, 604800};
+static const size_t latency_bound_count =
+    sizeof(latency_bounds) / sizeof(latency_bounds[0]);
+
 teleporteos::teleporteos(name s, name code, datastream<const char *> ds)
     : contract(s, code, ds), _deposits(get_self(), get_self().value),
       _oracles(get_self(), get_self().value),
       _receipts(get_self(), get_self().value),
       _teleports(get_self(), get_self().value),
-      _cancels(get_self(), get_self().value) {}
+      _cancels(get_self(), get_self().value),
+      _signatures(get_self(), get_self().value),
+      _latency(get_self(), get_self().value),
+      _coalesce(get_self(), get_self().value),
+      _checkpoints(get_self(), get_self().value) {}
 
 /* Notifications for tlm transfer */
 void teleporteos::transfer(name from, name to, asset quantity, string memo) {
@@ -69,9 +79,26 @@ void teleporteos::teleport(name from, asset quantity, uint8_t chain_id,
                      [&](auto &d) { d.quantity -= quantity; });
   }
 
+  if (_coalesce.find(from.value) != _coalesce.end() &&
+      _merge_teleport(from, eth_address, quantity, chain_id)) {
+    return;
+  }
+
   _add_teleport(from, eth_address, quantity, chain_id);
 }
 
+/* Opts an account in or out of merging teleports to the same destination */
+void teleporteos::coalesce(name account, bool enabled) {
+  require_auth(account);
+
+  auto existing = _coalesce.find(account.value);
+  if (enabled && existing == _coalesce.end()) {
+    _coalesce.emplace(account, [&](auto &c) { c.account = account; });
+  } else if (!enabled && existing != _coalesce.end()) {
+    _coalesce.erase(existing);
+  }
+}
+
 void teleporteos::refundrec(uint64_t id, checksum256 eth_address) {
   require_auth(get_self());
 
@@ -84,8 +111,11 @@ void teleporteos::refundrec(uint64_t id, checksum256 eth_address) {
                    // signing. The last one will be missing because the inline
                    // transfer will fail causing the whole sign action to fail
         "Not enough confirmations to refund. Required: 4");
-  _receipts.modify(*existing_receipt, get_self(),
-                   [&](auto &r) { r.completed = true; });
+  uint32_t now = current_time_point().sec_since_epoch();
+  _receipts.modify(*existing_receipt, get_self(), [&](auto &r) {
+    r.completed = true;
+    r.completed_time.emplace(now);
+  });
 
   _add_teleport(get_self(), eth_address, existing_receipt->quantity,
                 existing_receipt->chain_id);
@@ -101,6 +131,7 @@ void teleporteos::_add_teleport(name from, checksum256 eth_address,
                                 asset quantity, uint8_t chain_id) {
   uint64_t next_teleport_id = _teleports.available_primary_key();
   uint32_t now = current_time_point().sec_since_epoch();
+  vector<name> oracles = _assign_oracles(next_teleport_id);
   _teleports.emplace(get_self(), [&](auto &t) {
     t.id = next_teleport_id;
     t.time = now;
@@ -109,21 +140,84 @@ void teleporteos::_add_teleport(name from, checksum256 eth_address,
     t.chain_id = chain_id;
     t.eth_address = eth_address;
     t.claimed = false;
+    t.signature_count.emplace(0);
+    t.assigned_oracles.emplace(oracles);
+    t.quorum_time.emplace(0);
+    t.claimed_time.emplace(0);
   });
 
-  action(
-      permission_level{get_self(), "active"_n}, get_self(), "logteleport"_n,
-      make_tuple(next_teleport_id, now, from, quantity, chain_id, eth_address))
+  action(permission_level{get_self(), "active"_n}, get_self(), "logteleport"_n,
+         make_tuple(next_teleport_id, now, from, quantity, chain_id,
+                    eth_address, oracles))
       .send();
 }
 
+/*
+ * Adds quantity to the account's latest teleport if it goes to the same
+ * destination, was created within the coalesce window and has not been signed
+ * yet. The teleport is logged again so oracles sign the merged quantity.
+ */
+bool teleporteos::_merge_teleport(name from, checksum256 eth_address,
+                                  asset quantity, uint8_t chain_id) {
+  auto account_ind = _teleports.get_index<"byaccount"_n>();
+  auto latest = account_ind.upper_bound(from.value);
+  if (latest == account_ind.begin()) {
+    return false;
+  }
+  latest--;
+
+  uint32_t now = current_time_point().sec_since_epoch();
+  if (latest->account != from || uint8_t(latest->chain_id) != chain_id ||
+      latest->eth_address != eth_address || latest->claimed ||
+      !latest->oracles.empty() || latest->signature_count.value_or() > 0 ||
+      latest->time + COALESCE_WINDOW_SECONDS < now) {
+    return false;
+  }
+
+  account_ind.modify(latest, same_payer,
+                     [&](auto &t) { t.quantity += quantity; });
+
+  action(permission_level{get_self(), "active"_n}, get_self(), "logteleport"_n,
+         make_tuple(latest->id, latest->time, from, latest->quantity, chain_id,
+                    eth_address, latest->assigned_oracles.value_or()))
+      .send();
+
+  return true;
+}
+
+/*
+ * Picks the oracles expected to sign a teleport, a window of the registered
+ * oracles a little larger than the signature threshold which rotates with the
+ * teleport id so signing load is spread across all oracles
+ */
+vector<name> teleporteos::_assign_oracles(uint64_t teleport_id) {
+  vector<name> registered;
+  for (auto &o : _oracles) {
+    registered.push_back(o.account);
+  }
+
+  vector<name> assigned;
+  if (registered.empty()) {
+    return assigned;
+  }
+
+  size_t count = std::min(registered.size(),
+                          size_t(TELEPORT_SIGNATURES + ASSIGNED_SPARE_ORACLES));
+  size_t start = teleport_id % registered.size();
+  for (size_t i = 0; i < count; i++) {
+    assigned.push_back(registered[(start + i) % registered.size()]);
+  }
+
+  return assigned;
+}
+
 /* Cancels a teleport after 30 days and no claim */
 void teleporteos::cancel(uint64_t id) {
   auto teleport = _teleports.find(id);
   check(teleport != _teleports.end(), "Teleport not found");
 
   require_auth(teleport->account);
-  check(!teleport->claimed, "Teleport is already claimed");
+  check(!_is_claimed(*teleport), "Teleport is already claimed");
 
   /* wait 32 days to give time to mark as claimed */
   uint32_t expiry_time_seconds = 60 * 60 * 24 * 30;
@@ -145,26 +239,70 @@ void teleporteos::cancel(uint64_t id) {
 
 void teleporteos::logteleport(uint64_t id, uint32_t timestamp, name from,
                               asset quantity, uint8_t chain_id,
-                              checksum256 eth_address) {
-  // Logs the teleport id for the oracle to listen to
+                              checksum256 eth_address,
+                              binary_extension<vector<name>> oracles) {
+  // Logs the teleport id for the oracle to listen to, oracles is an extension
+  // so logteleport actions from before assignment still deserialize
   require_auth(get_self());
 }
 
-void teleporteos::sign(name oracle_name, uint64_t id, string signature) {
+void teleporteos::sign(name oracle_name, uint64_t id, string signature,
+                       asset quantity) {
   // Signs receipt of tokens, these signatures must be passed to the eth
   // blockchain in the claim function on the eth contract
   require_oracle(oracle_name);
 
   auto teleport = _teleports.find(id);
   check(teleport != _teleports.end(), "Teleport not found");
+  // quantity is the amount in the signed data, a coalesced teleport may have
+  // been merged after the oracle read it
+  check(teleport->quantity == quantity, "Quantity does not match teleport");
 
   auto find_res = std::find(teleport->oracles.begin(), teleport->oracles.end(),
                             oracle_name);
   check(find_res == teleport->oracles.end(), "Oracle has already signed");
 
-  _teleports.modify(*teleport, get_self(), [&](auto &t) {
-    t.oracles.push_back(oracle_name);
-    t.signatures.push_back(signature);
+  // Only assigned oracles may sign until the assignment times out, after that
+  // any oracle can help complete the teleport
+  auto assigned = teleport->assigned_oracles.value_or();
+  if (!assigned.empty() &&
+      std::find(assigned.begin(), assigned.end(), oracle_name) ==
+          assigned.end()) {
+    uint32_t now = current_time_point().sec_since_epoch();
+    check(teleport->time + ASSIGNMENT_TIMEOUT_SECONDS <= now,
+          "Oracle is not assigned to this teleport");
+  }
+
+  // Each signature gets its own row so signing is a constant size insert
+  // instead of rewriting every earlier signature on the teleport row
+  uint8_t slot = 0;
+  for (auto sig = _signatures.lower_bound(signature_key(id, 0));
+       sig != _signatures.end() && sig->teleport_id == id; sig++, slot++) {
+    check(sig->oracle != oracle_name, "Oracle has already signed");
+  }
+  check(slot < 0xff, "Too many signatures");
+
+  _signatures.emplace(get_self(), [&](auto &s) {
+    s.key = signature_key(id, slot);
+    s.teleport_id = id;
+    s.oracle = oracle_name;
+    s.signature = signature;
+  });
+
+  uint32_t now = current_time_point().sec_since_epoch();
+  bool quorum = teleport->oracles.size() + slot + 1 == TELEPORT_SIGNATURES;
+  if (teleport->oracles.empty() && slot == 0) {
+    _record_latency(teleport->chain_id, STAGE_FIRST_SIGN, now - teleport->time);
+  }
+  if (quorum) {
+    _record_latency(teleport->chain_id, STAGE_QUORUM, now - teleport->time);
+  }
+
+  _teleports.modify(*teleport, same_payer, [&](auto &t) {
+    t.extend();
+    t.signature_count.emplace(slot + 1);
+    if (quorum)
+      t.quorum_time.emplace(now);
   });
 }
 
@@ -218,10 +356,18 @@ void teleporteos::received(name oracle_name, name to, checksum256 ref,
         completed = true;
       }
 
+      uint32_t now = current_time_point().sec_since_epoch();
+      if (completed) {
+        _record_latency(receipt->chain_id, STAGE_RECEIVED,
+                        now - receipt->date.sec_since_epoch());
+      }
+
       _receipts.modify(*receipt, get_self(), [&](auto &r) {
         r.confirmations = receipt->confirmations + 1;
         r.approvers.push_back(oracle_name);
         r.completed = completed;
+        if (completed)
+          r.completed_time.emplace(now);
       });
     } else {
       check(false, "Another oracle has already registered teleport");
@@ -229,6 +375,80 @@ void teleporteos::received(name oracle_name, name to, checksum256 ref,
   }
 }
 
+/*
+ * Confirms a receipt with signatures from several oracles in one action, any
+ * account can relay it once enough oracles have signed the receipt digest
+ */
+void teleporteos::receivedsig(name to, checksum256 ref, asset quantity,
+                              uint8_t chain_id, vector<signature> signatures) {
+  check(quantity.amount > 0, "Quantity cannot be negative");
+  check(quantity.is_valid(), "Asset not valid");
+
+  auto ref_ind = _receipts.get_index<"byref"_n>();
+  auto receipt = ref_ind.find(ref);
+
+  vector<name> approvers;
+  if (receipt != ref_ind.end()) {
+    check(!receipt->completed, "This teleport has already completed");
+    check(receipt->quantity == quantity, "Quantity mismatch");
+    check(receipt->to == to, "Account mismatch");
+    check(receipt->chain_id == chain_id, "Chain mismatch");
+    approvers = receipt->approvers;
+  }
+
+  checksum256 digest = receipt_digest(to, ref, quantity, chain_id);
+  for (auto &sig : signatures) {
+    public_key key = recover_key(digest, sig);
+
+    auto oracle = _oracles.begin();
+    while (oracle != _oracles.end() &&
+           !(oracle->key.has_value() && oracle->key.value() == key)) {
+      oracle++;
+    }
+    check(oracle != _oracles.end(), "Signature is not from an oracle");
+
+    auto existing =
+        find(approvers.begin(), approvers.end(), oracle->account);
+    if (existing == approvers.end()) {
+      approvers.push_back(oracle->account);
+    }
+  }
+
+  check(approvers.size() >= ORACLE_CONFIRMATIONS,
+        "Not enough valid signatures");
+
+  string memo = "Teleport";
+  action(permission_level{get_self(), "active"_n}, TOKEN_CONTRACT,
+         "transfer"_n, make_tuple(get_self(), to, quantity, memo))
+      .send();
+
+  uint32_t now = current_time_point().sec_since_epoch();
+  if (receipt == ref_ind.end()) {
+    // no earlier confirmation to measure from, so no latency sample
+    _receipts.emplace(get_self(), [&](auto &r) {
+      r.id = _receipts.available_primary_key();
+      r.date = current_time_point();
+      r.ref = ref;
+      r.chain_id = chain_id;
+      r.to = to;
+      r.quantity = quantity;
+      r.confirmations = approvers.size();
+      r.approvers = approvers;
+      r.completed = true;
+      r.completed_time.emplace(now);
+    });
+  } else {
+    _record_latency(receipt->chain_id, STAGE_RECEIVED,
+                    now - receipt->date.sec_since_epoch());
+    _receipts.modify(*receipt, get_self(), [&](auto &r) {
+      r.confirmations = approvers.size();
+      r.approvers = approvers;
+      r.completed = true;
+      r.completed_time.emplace(now);
+    });
+  }
+}
+
 void teleporteos::repairrec(uint64_t id, asset quantity, vector<name> approvers,
                             bool completed) {
   require_auth(get_self());
@@ -238,10 +458,13 @@ void teleporteos::repairrec(uint64_t id, asset quantity, vector<name> approvers,
   check(quantity.amount > 0, "Quantity cannot be negative");
   check(quantity.is_valid(), "Asset not valid");
 
+  uint32_t now = current_time_point().sec_since_epoch();
   _receipts.modify(*receipt, get_self(), [&](receipt_item &r) {
     r.confirmations = approvers.size();
     r.approvers = approvers;
     r.quantity = quantity;
+    if (completed && !r.completed)
+      r.completed_time.emplace(now);
     r.completed = completed;
   });
 }
@@ -268,7 +491,12 @@ void teleporteos::repairtel(uint64_t id, optional<name> from,
 
     t.oracles = {};
     t.signatures = {};
+    t.extend();
+    t.signature_count.emplace(0);
+    t.quorum_time.emplace(0);
   });
+
+  erase_signatures(id);
 }
 
 /*
@@ -285,7 +513,99 @@ void teleporteos::claimed(name oracle_name, uint64_t id, checksum256 to_eth,
   check(teleport->eth_address == to_eth, "Account mismatch");
   check(!teleport->claimed, "Already marked as claimed");
 
-  _teleports.modify(*teleport, same_payer, [&](auto &t) { t.claimed = true; });
+  _mark_claimed(teleport, current_time_point().sec_since_epoch());
+}
+
+/*
+ * Records the claims an oracle saw in an EVM block range as one checkpoint
+ * instead of one claimed action per teleport. The submission which brings a
+ * checkpoint to quorum marks the first CHECKPOINT_SWEEP_ROWS teleports as
+ * claimed, sweepclaims works through the rest. Until then cancel and
+ * isclaimed check the checkpoint directly.
+ */
+void teleporteos::claimckpt(name oracle_name, uint8_t chain_id,
+                            uint64_t from_block, uint64_t to_block,
+                            uint64_t base_id, vector<char> bitmap) {
+  require_oracle(oracle_name);
+
+  check(from_block <= to_block, "Invalid block range");
+  check(!bitmap.empty(), "Bitmap is empty");
+  check(bitmap.size() <= CHECKPOINT_MAX_BITMAP_BYTES, "Bitmap is too large");
+  check(base_id < (uint64_t(1) << 56), "Base id is too large");
+
+  auto data = pack(make_tuple(chain_id, from_block, to_block, base_id, bitmap));
+  checksum256 hash = sha256(data.data(), data.size());
+  uint32_t now = current_time_point().sec_since_epoch();
+
+  auto hash_ind = _checkpoints.get_index<"byhash"_n>();
+  auto existing = hash_ind.find(hash);
+  uint64_t checkpoint_id;
+  if (existing == hash_ind.end()) {
+    checkpoint_id = _checkpoints.available_primary_key();
+    _checkpoints.emplace(get_self(), [&](auto &c) {
+      c.id = checkpoint_id;
+      c.chain_id = chain_id;
+      c.from_block = from_block;
+      c.to_block = to_block;
+      c.base_id = base_id;
+      c.bitmap = bitmap;
+      c.hash = hash;
+      c.oracles = {oracle_name};
+      c.time = now;
+      c.swept = 0;
+    });
+  } else {
+    auto find_res = std::find(existing->oracles.begin(),
+                              existing->oracles.end(), oracle_name);
+    check(find_res == existing->oracles.end(),
+          "Oracle has already submitted checkpoint");
+
+    checkpoint_id = existing->id;
+    hash_ind.modify(existing, same_payer,
+                    [&](auto &c) { c.oracles.push_back(oracle_name); });
+  }
+
+  auto checkpoint = _checkpoints.find(checkpoint_id);
+  if (checkpoint->effective() && !checkpoint->swept_all()) {
+    _sweep_checkpoint(checkpoint, CHECKPOINT_SWEEP_ROWS);
+  }
+
+  _prune_checkpoints(now);
+}
+
+/*
+ * Marks up to max_rows more teleports covered by an effective checkpoint as
+ * claimed, anyone can call this to work through the backlog. Checkpoints
+ * which are fully swept or never reached quorum are erased once expired.
+ */
+void teleporteos::sweepclaims(uint64_t checkpoint_id, uint32_t max_rows) {
+  auto checkpoint =
+      _checkpoints.require_find(checkpoint_id, "Checkpoint not found");
+
+  if (checkpoint->effective() && !checkpoint->swept_all()) {
+    _sweep_checkpoint(checkpoint, max_rows);
+    return;
+  }
+
+  uint32_t now = current_time_point().sec_since_epoch();
+  check(checkpoint->expired(now), checkpoint->effective()
+                                      ? "Checkpoint is already swept"
+                                      : "Checkpoint has not reached quorum");
+  _checkpoints.erase(checkpoint);
+}
+
+void teleporteos::delckpt(uint64_t checkpoint_id) {
+  require_auth(get_self());
+
+  auto checkpoint =
+      _checkpoints.require_find(checkpoint_id, "Checkpoint not found");
+  _checkpoints.erase(checkpoint);
+}
+
+/* Read-only claim status including checkpoints which are not swept yet */
+bool teleporteos::isclaimed(uint64_t id) {
+  auto teleport = _teleports.require_find(id, "Teleport not found");
+  return _is_claimed(*teleport);
 }
 
 void teleporteos::regoracle(name oracle_name) {
@@ -305,6 +625,20 @@ void teleporteos::unregoracle(name oracle_name) {
   _oracles.erase(oracle);
 }
 
+void teleporteos::setkey(name oracle_name, public_key key) {
+  require_oracle(oracle_name);
+
+  // receivedsig maps a recovered key back to a single oracle
+  for (auto &o : _oracles) {
+    check(o.account == oracle_name || !o.key.has_value() ||
+              o.key.value() != key,
+          "Key is already used by another oracle");
+  }
+
+  auto oracle = _oracles.find(oracle_name.value);
+  _oracles.modify(oracle, same_payer, [&](auto &o) { o.key.emplace(key); });
+}
+
 void teleporteos::delreceipts() {
   require_auth(get_self());
 
@@ -321,6 +655,11 @@ void teleporteos::delteles() {
   while (tp != _teleports.end()) {
     tp = _teleports.erase(tp);
   }
+
+  auto sig = _signatures.begin();
+  while (sig != _signatures.end()) {
+    sig = _signatures.erase(sig);
+  }
 }
 
 /* Private */
@@ -329,3 +668,149 @@ void teleporteos::require_oracle(name account) {
   require_auth(account);
   _oracles.get(account.value, "Account is not an oracle");
 }
+
+bool teleporteos::_is_claimed(const teleport_item &teleport) {
+  if (teleport.claimed) {
+    return true;
+  }
+
+  // a bitmap covers at most this many ids, so only checkpoints based that
+  // far below the teleport can cover it
+  uint64_t span = CHECKPOINT_MAX_BITMAP_BYTES * 8;
+  uint64_t lowest = teleport.id >= span ? teleport.id - span + 1 : 0;
+  uint8_t chain_id = uint8_t(teleport.chain_id);
+
+  auto base_ind = _checkpoints.get_index<"bybase"_n>();
+  auto upper = checkpoint_base_key(chain_id, teleport.id);
+  for (auto c = base_ind.lower_bound(checkpoint_base_key(chain_id, lowest));
+       c != base_ind.end() && c->by_base() <= upper; c++) {
+    if (c->effective() && c->covers(teleport.id)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/* claimed_time is when the claim was reported, which is earlier than now for
+ * teleports swept from a checkpoint */
+void teleporteos::_mark_claimed(teleports_table::const_iterator teleport,
+                                uint32_t claimed_time) {
+  _record_latency(teleport->chain_id, STAGE_CLAIMED,
+                  claimed_time > teleport->time ? claimed_time - teleport->time
+                                                : 0);
+
+  _teleports.modify(teleport, same_payer, [&](auto &t) {
+    t.claimed = true;
+    t.extend();
+    t.claimed_time.emplace(claimed_time);
+  });
+}
+
+/* Marks up to max_rows covered teleports as claimed from where the last
+ * sweep stopped, claims are dated by the first checkpoint submission */
+void teleporteos::_sweep_checkpoint(
+    checkpoints_table::const_iterator checkpoint, uint32_t max_rows) {
+  uint64_t bits = checkpoint->bitmap.size() * 8;
+  uint64_t bit = checkpoint->swept;
+  uint32_t rows = 0;
+  while (bit < bits) {
+    if (checkpoint->bitmap[bit / 8] == 0) {
+      bit = (bit / 8 + 1) * 8; // skip the rest of an empty byte
+      continue;
+    }
+    if (!checkpoint->covers(checkpoint->base_id + bit)) {
+      bit++;
+      continue;
+    }
+    if (rows == max_rows) {
+      break;
+    }
+    rows++;
+
+    auto teleport = _teleports.find(checkpoint->base_id + bit);
+    if (teleport != _teleports.end() && !teleport->claimed &&
+        uint8_t(teleport->chain_id) == checkpoint->chain_id) {
+      _mark_claimed(teleport, checkpoint->time);
+    }
+    bit++;
+  }
+
+  _checkpoints.modify(checkpoint, same_payer, [&](auto &c) { c.swept = bit; });
+}
+
+/* Erases up to two expired checkpoints which have nothing left to sweep,
+ * ids only grow so the oldest checkpoints are at the front */
+void teleporteos::_prune_checkpoints(uint32_t now) {
+  auto checkpoint = _checkpoints.begin();
+  for (int i = 0; i < 2 && checkpoint != _checkpoints.end(); i++) {
+    if (!checkpoint->expired(now) ||
+        (checkpoint->effective() && !checkpoint->swept_all())) {
+      break;
+    }
+    checkpoint = _checkpoints.erase(checkpoint);
+  }
+}
+
+/* Adds one latency sample to the histogram for a chain and stage */
+void teleporteos::_record_latency(uint8_t chain_id, latency_stage stage,
+                                  uint32_t seconds) {
+  static const name stage_names[] = {"firstsign"_n, "quorum"_n, "claimed"_n,
+                                     "received"_n};
+
+  size_t bucket = 0;
+  while (bucket < latency_bound_count && seconds > latency_bounds[bucket]) {
+    bucket++;
+  }
+
+  uint64_t key = (uint64_t(chain_id) << 8) | stage;
+  auto existing = _latency.find(key);
+  if (existing == _latency.end()) {
+    _latency.emplace(get_self(), [&](auto &l) {
+      l.key = key;
+      l.chain_id = chain_id;
+      l.stage = stage_names[stage];
+      l.count = 1;
+      l.total_seconds = seconds;
+      l.max_seconds = seconds;
+      l.buckets.resize(latency_bound_count + 1);
+      l.buckets[bucket] = 1;
+    });
+  } else {
+    _latency.modify(existing, same_payer, [&](auto &l) {
+      l.count++;
+      l.total_seconds += seconds;
+      l.max_seconds = std::max(l.max_seconds, seconds);
+      l.buckets[bucket]++;
+    });
+  }
+}
+
+static checksum256 receipt_chain_id() {
+  auto nibble = [](char c) -> uint8_t {
+    return c <= '9' ? c - '0' : c - 'a' + 10;
+  };
+  const char *hex = RECEIPT_CHAIN_ID_STR;
+  array<uint8_t, 32> bytes;
+  for (size_t i = 0; i < bytes.size(); i++) {
+    bytes[i] = (nibble(hex[2 * i]) << 4) | nibble(hex[2 * i + 1]);
+  }
+  return checksum256(bytes);
+}
+
+/*
+ * Digest signed by oracles to confirm a receipt in receivedsig, the packed
+ * (chain id, contract, to, ref, quantity, evm chain id) tuple
+ */
+checksum256 teleporteos::receipt_digest(name to, checksum256 ref,
+                                        asset quantity, uint8_t chain_id) {
+  auto data = pack(make_tuple(receipt_chain_id(), get_self(), to, ref,
+                              quantity, chain_id));
+  return sha256(data.data(), data.size());
+}
+
+void teleporteos::erase_signatures(uint64_t teleport_id) {
+  auto sig = _signatures.lower_bound(signature_key(teleport_id, 0));
+  while (sig != _signatures.end() && sig->teleport_id == teleport_id) {
+    sig = _signatures.erase(sig);
+  }
+}
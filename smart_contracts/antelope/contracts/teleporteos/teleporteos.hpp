@@ -1,4 +1,6 @@
 #include <eosio/asset.hpp>
+#include <eosio/binary_extension.hpp>
+#include <eosio/crypto.hpp>
 #include <eosio/eosio.hpp>
 #include <eosio/transaction.hpp>
 #include <math.h>
@@ -7,6 +9,28 @@ using namespace eosio;
 using namespace std;
 
 #define ORACLE_CONFIRMATIONS 5
+#define TELEPORT_SIGNATURES 3
+#define ASSIGNED_SPARE_ORACLES 2
+#define COALESCE_WINDOW_SECONDS 300
+#define CHECKPOINT_MAX_BITMAP_BYTES 32
+#ifdef IS_DEV
+#define ASSIGNMENT_TIMEOUT_SECONDS 5
+#define CHECKPOINT_SWEEP_ROWS 1
+#define CHECKPOINT_EXPIRY_SECONDS 30
+#else
+#define ASSIGNMENT_TIMEOUT_SECONDS 600
+#define CHECKPOINT_SWEEP_ROWS 32
+#define CHECKPOINT_EXPIRY_SECONDS (60 * 60 * 24)
+#endif
+/* Antelope chain id covered by receivedsig signatures, so a receipt signed for
+ * one chain cannot be replayed on another with the same contract account */
+#if defined(IS_DEV) || defined(WAX_TESTNET)
+#define RECEIPT_CHAIN_ID_STR                                                   \
+  "f16b1833c747c43682f4386fca9cbb327929334a762755ebec17f6f23c9b8a12"
+#else
+#define RECEIPT_CHAIN_ID_STR                                                   \
+  "1064487b3cd1a897ce03ae5b6a865651747e2e152090f99c1d19d44e01aea5a4"
+#endif
 #define TOKEN_CONTRACT_STR "alien.worlds"
 #define TOKEN_CONTRACT name(TOKEN_CONTRACT_STR)
 
@@ -22,7 +46,8 @@ private:
   };
   typedef multi_index<"deposits"_n, deposit_item> deposits_table;
 
-  /* Represents a teleport in progress */
+  /* Represents a teleport in progress, oracles and signatures are only
+   * populated for teleports signed before the signatures table was added */
   struct [[eosio::table("teleports")]] teleport_item {
     uint64_t id;
     uint32_t time;
@@ -33,8 +58,25 @@ private:
     vector<name> oracles;
     vector<string> signatures;
     bool claimed;
+    binary_extension<uint8_t> signature_count;
+    binary_extension<vector<name>> assigned_oracles;
+    binary_extension<uint32_t> quorum_time;
+    binary_extension<uint32_t> claimed_time;
 
     uint64_t primary_key() const { return id; }
+
+    /* Extensions are serialized in order, so earlier ones must be present
+     * before a later one is set on rows created by an older contract */
+    void extend() {
+      if (!signature_count.has_value())
+        signature_count.emplace(0);
+      if (!assigned_oracles.has_value())
+        assigned_oracles.emplace();
+      if (!quorum_time.has_value())
+        quorum_time.emplace(0);
+      if (!claimed_time.has_value())
+        claimed_time.emplace(0);
+    }
     uint64_t by_account() const { return account.value; }
   };
   typedef multi_index<
@@ -43,6 +85,76 @@ private:
                                               &teleport_item::by_account>>>
       teleports_table;
 
+  static uint64_t checkpoint_base_key(uint8_t chain_id, uint64_t base_id) {
+    return (uint64_t(chain_id) << 56) | base_id;
+  }
+
+  /* Claims seen by oracles in a block range of one EVM chain, bit i of
+   * bitmap marks teleport base_id + i as claimed. Takes effect once
+   * TELEPORT_SIGNATURES oracles submitted the same checkpoint, swept marks
+   * how far covered teleports have been marked claimed. Kept until
+   * CHECKPOINT_EXPIRY_SECONDS after the first submission so late oracles add
+   * to it instead of starting a new one, then pruned unless it still has
+   * teleports to sweep */
+  struct [[eosio::table("checkpoints")]] checkpoint_item {
+    uint64_t id;
+    uint8_t chain_id;
+    uint64_t from_block;
+    uint64_t to_block;
+    uint64_t base_id;
+    vector<char> bitmap; // bytes in the ABI, sent as hex
+    checksum256 hash;
+    vector<name> oracles;
+    uint32_t time;
+    uint64_t swept;
+
+    uint64_t primary_key() const { return id; }
+    checksum256 by_hash() const { return hash; }
+    uint64_t by_base() const { return checkpoint_base_key(chain_id, base_id); }
+    bool effective() const { return oracles.size() >= TELEPORT_SIGNATURES; }
+    bool swept_all() const { return swept >= bitmap.size() * 8; }
+    bool expired(uint32_t now) const {
+      return time + CHECKPOINT_EXPIRY_SECONDS <= now;
+    }
+    bool covers(uint64_t teleport_id) const {
+      if (teleport_id < base_id || teleport_id - base_id >= bitmap.size() * 8)
+        return false;
+      uint64_t bit = teleport_id - base_id;
+      return uint8_t(bitmap[bit / 8]) & (1 << (bit % 8));
+    }
+  };
+  typedef multi_index<
+      "checkpoints"_n, checkpoint_item,
+      indexed_by<"byhash"_n, const_mem_fun<checkpoint_item, checksum256,
+                                           &checkpoint_item::by_hash>>,
+      indexed_by<"bybase"_n, const_mem_fun<checkpoint_item, uint64_t,
+                                           &checkpoint_item::by_base>>>
+      checkpoints_table;
+
+  /* Accounts which opted in to merging teleports to the same destination */
+  struct [[eosio::table("coalesce")]] coalesce_item {
+    name account;
+
+    uint64_t primary_key() const { return account.value; }
+  };
+  typedef multi_index<"coalesce"_n, coalesce_item> coalesce_table;
+
+  /* One oracle signature for a teleport, keyed by teleport id and slot so
+   * all signatures for a teleport can be read with a single range query */
+  struct [[eosio::table("signatures")]] signature_item {
+    uint64_t key;
+    uint64_t teleport_id;
+    name oracle;
+    string signature;
+
+    uint64_t primary_key() const { return key; }
+  };
+  typedef multi_index<"signatures"_n, signature_item> signatures_table;
+
+  static uint64_t signature_key(uint64_t teleport_id, uint8_t slot) {
+    return (teleport_id << 8) | slot;
+  }
+
   struct [[eosio::table("cancels")]] cancel_item {
     uint64_t teleport_id;
 
@@ -50,9 +162,11 @@ private:
   };
   typedef multi_index<"cancels"_n, cancel_item> cancels_table;
 
-  /* Oracles authorised to send receipts */
+  /* Oracles authorised to send receipts, key is used to verify signed
+   * receipts submitted through receivedsig */
   struct [[eosio::table("oracles")]] oracle_item {
     name account;
+    binary_extension<public_key> key;
 
     uint64_t primary_key() const { return account.value; }
   };
@@ -69,6 +183,7 @@ private:
     asset quantity;
     vector<name> approvers;
     bool completed;
+    binary_extension<uint32_t> completed_time;
 
     uint64_t primary_key() const { return id; }
     uint64_t by_to() const { return to.value; }
@@ -82,13 +197,43 @@ private:
                  const_mem_fun<receipt_item, uint64_t, &receipt_item::by_to>>>
       receipts_table;
 
+  /* Latency histogram for one stage of teleports or receipts on one chain.
+   * buckets[i] counts latencies up to latency_bounds[i] seconds, the last
+   * bucket counts everything slower */
+  struct [[eosio::table("latency")]] latency_item {
+    uint64_t key;
+    uint8_t chain_id;
+    name stage;
+    uint32_t count;
+    uint64_t total_seconds;
+    uint32_t max_seconds;
+    vector<uint32_t> buckets;
+
+    uint64_t primary_key() const { return key; }
+  };
+  typedef multi_index<"latency"_n, latency_item> latency_table;
+
+  enum latency_stage : uint8_t {
+    STAGE_FIRST_SIGN = 0,
+    STAGE_QUORUM = 1,
+    STAGE_CLAIMED = 2,
+    STAGE_RECEIVED = 3
+  };
+
   deposits_table _deposits;
   oracles_table _oracles;
   receipts_table _receipts;
   teleports_table _teleports;
   cancels_table _cancels;
+  signatures_table _signatures;
+  latency_table _latency;
+  coalesce_table _coalesce;
+  checkpoints_table _checkpoints;
 
   void require_oracle(name account);
+  checksum256 receipt_digest(name to, checksum256 ref, asset quantity,
+                             uint8_t chain_id);
+  void erase_signatures(uint64_t teleport_id);
 
 public:
   using contract::contract;
@@ -102,8 +247,10 @@ public:
   ACTION teleport(name from, asset quantity, uint8_t chain_id,
                   checksum256 eth_address);
   ACTION logteleport(uint64_t id, uint32_t timestamp, name from, asset quantity,
-                     uint8_t chain_id, checksum256 eth_address);
-  ACTION sign(name oracle_name, uint64_t id, string signature);
+                     uint8_t chain_id, checksum256 eth_address,
+                     binary_extension<vector<name>> oracles);
+  ACTION sign(name oracle_name, uint64_t id, string signature,
+              asset quantity);
   ACTION repairrec(uint64_t id, asset quantity, vector<name> approvers,
                    bool completed);
   ACTION repairtel(uint64_t id, optional<name> from, optional<asset> quantity,
@@ -112,19 +259,38 @@ public:
   ACTION injecttel(name from, checksum256 eth_address, asset quantity,
                    uint8_t chain_id);
   ACTION withdraw(name from, asset quantity);
+  ACTION coalesce(name account, bool enabled);
   ACTION cancel(uint64_t id);
   ACTION received(name oracle_name, name to, checksum256 ref, asset quantity,
                   uint8_t chain_id, bool confirmed);
+  ACTION receivedsig(name to, checksum256 ref, asset quantity,
+                     uint8_t chain_id, vector<signature> signatures);
   ACTION claimed(name oracle_name, uint64_t id, checksum256 to_eth,
                  asset quantity);
+  ACTION claimckpt(name oracle_name, uint8_t chain_id, uint64_t from_block,
+                   uint64_t to_block, uint64_t base_id, vector<char> bitmap);
+  ACTION sweepclaims(uint64_t checkpoint_id, uint32_t max_rows);
+  ACTION delckpt(uint64_t checkpoint_id);
+  [[eosio::action]] bool isclaimed(uint64_t id);
   ACTION regoracle(name oracle_name);
   ACTION unregoracle(name oracle_name);
-  ACTION sign(string signature);
+  ACTION setkey(name oracle_name, public_key key);
   ACTION delreceipts();
   ACTION delteles();
 
 private:
   void _add_teleport(name from, checksum256 eth_address, asset quantity,
                      uint8_t chain_id);
+  bool _merge_teleport(name from, checksum256 eth_address, asset quantity,
+                       uint8_t chain_id);
+  vector<name> _assign_oracles(uint64_t teleport_id);
+  bool _is_claimed(const teleport_item &teleport);
+  void _mark_claimed(teleports_table::const_iterator teleport,
+                     uint32_t claimed_time);
+  void _sweep_checkpoint(checkpoints_table::const_iterator checkpoint,
+                         uint32_t max_rows);
+  void _prune_checkpoints(uint32_t now);
+  void _record_latency(uint8_t chain_id, latency_stage stage,
+                       uint32_t seconds);
 };
 } // namespace alienworlds
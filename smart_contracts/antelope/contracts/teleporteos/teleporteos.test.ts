@@ -6,8 +6,13 @@ import {
   assertEOSErrorIncludesMessage,
   assertMissingAuthority,
   UpdateAuth,
+  EOSManager,
 } from 'lamington';
 import * as chai from 'chai';
+import { createHash } from 'crypto';
+import { TextDecoder, TextEncoder } from 'util';
+import { Serialize } from 'eosjs';
+const ecc = require('eosjs-ecc');
 
 import { Teleporteos } from './teleporteos';
 import { EosioToken } from '../eosio.token/eosio.token';
@@ -15,6 +20,10 @@ import { EosioToken } from '../eosio.token/eosio.token';
 const ethToken =
   '2222222222222222222222222222222222222222222222222222222222222222';
 
+// RECEIPT_CHAIN_ID_STR in IS_DEV builds
+const RECEIPT_CHAIN_ID =
+  'f16b1833c747c43682f4386fca9cbb327929334a762755ebec17f6f23c9b8a12';
+
 let teleporteos: Teleporteos;
 let alienworldsToken: EosioToken;
 
@@ -26,6 +35,7 @@ let oracle3: Account;
 let removedOracle: Account;
 let oracle4: Account;
 let oracle5: Account;
+let oracle6: Account;
 
 describe('teleporteos', async () => {
   before(async () => {
@@ -70,6 +80,11 @@ describe('teleporteos', async () => {
           from: teleporteos.account,
         });
       });
+      it('should succeed to add another oracle', async () => {
+        await teleporteos.regoracle(oracle6.name, {
+          from: teleporteos.account,
+        });
+      });
       it('should update oracles table', async () => {
         await assertRowsEqual(teleporteos.oraclesTable(), [
           { account: oracle1.name },
@@ -78,6 +93,7 @@ describe('teleporteos', async () => {
           { account: removedOracle.name },
           { account: oracle4.name },
           { account: oracle5.name },
+          { account: oracle6.name },
         ]);
       });
     });
@@ -103,6 +119,7 @@ describe('teleporteos', async () => {
           { account: oracle3.name },
           { account: oracle4.name },
           { account: oracle5.name },
+          { account: oracle6.name },
         ]);
       });
     });
@@ -510,10 +527,95 @@ describe('teleporteos', async () => {
           chai.expect(item.oracles).empty;
           chai.expect(item.signatures).empty;
           chai.expect(item.claimed).false;
+          chai.expect(item.signature_count).equal(0);
+          chai
+            .expect(item.assigned_oracles)
+            .deep.equal([
+              oracle1.name,
+              oracle2.name,
+              oracle3.name,
+              oracle4.name,
+              oracle5.name,
+            ]);
         });
       });
     });
   });
+  context('sign', async () => {
+    context('with unregistered oracle', async () => {
+      it('should fail', async () => {
+        await assertEOSErrorIncludesMessage(
+          teleporteos.sign(sender1.name, 0, 'sig1', '123.0000 TLM', {
+            from: sender1,
+          }),
+          'Account is not an oracle'
+        );
+      });
+    });
+    context('with non-existing teleport', async () => {
+      it('should fail with not found error', async () => {
+        await assertEOSErrorIncludesMessage(
+          teleporteos.sign(oracle1.name, 10, 'sig1', '123.0000 TLM', {
+            from: oracle1,
+          }),
+          'Teleport not found'
+        );
+      });
+    });
+    context('with a different quantity than the teleport', async () => {
+      it('should fail', async () => {
+        await assertEOSErrorIncludesMessage(
+          teleporteos.sign(oracle1.name, 0, 'sig1', '100.0000 TLM', {
+            from: oracle1,
+          }),
+          'Quantity does not match teleport'
+        );
+      });
+    });
+    context('with valid params', async () => {
+      it('should succeed', async () => {
+        await teleporteos.sign(oracle1.name, 0, 'sig1', '123.0000 TLM', {
+          from: oracle1,
+        });
+        await teleporteos.sign(oracle2.name, 0, 'sig2', '123.0000 TLM', {
+          from: oracle2,
+        });
+      });
+      it('should fail for an oracle that has already signed', async () => {
+        await assertEOSErrorIncludesMessage(
+          teleporteos.sign(oracle1.name, 0, 'sig1', '123.0000 TLM', {
+            from: oracle1,
+          }),
+          'Oracle has already signed'
+        );
+      });
+      it('should insert a row per signature', async () => {
+        await assertRowsEqual(teleporteos.signaturesTable(), [
+          { key: 0, teleport_id: 0, oracle: oracle1.name, signature: 'sig1' },
+          { key: 1, teleport_id: 0, oracle: oracle2.name, signature: 'sig2' },
+        ]);
+      });
+      it('should update the signature count', async () => {
+        let {
+          rows: [item],
+        } = await teleporteos.teleportsTable();
+        chai.expect(item.signature_count).equal(2);
+        chai.expect(item.oracles).empty;
+        chai.expect(item.signatures).empty;
+      });
+      it('should record latency histograms', async () => {
+        let { rows } = await teleporteos.latencyTable();
+        let firstSign = rows.find((r) => r.stage === 'firstsign');
+        chai.expect(firstSign.chain_id).equal(2);
+        chai.expect(firstSign.count).equal(1);
+        chai.expect(firstSign.buckets.length).equal(13);
+        chai.expect(rows.find((r) => r.stage === 'quorum')).undefined;
+
+        let received = rows.find((r) => r.stage === 'received');
+        chai.expect(received.count).equal(1);
+      });
+    });
+  });
   context('refund receipt', async () => {
     context('without valid auth', async () => {
       it('should fail with auth error', async () => {
@@ -641,6 +743,8 @@ describe('teleporteos', async () => {
 
         chai.expect(item.chain_id).equal(2);
         chai.expect(item.approvers.length).equal(4);
+        chai.expect(item.completed).true;
+        chai.expect(item.completed_time).above(0);
       });
       it('should insert a teleport into the table', async () => {
         let { rows } = await teleporteos.teleportsTable();
@@ -654,11 +758,585 @@ describe('teleporteos', async () => {
             '2222222222222222222222222222222222222222222222222222222222222222'
           );
       });
+      it('should assign the next window of oracles', async () => {
+        let { rows } = await teleporteos.teleportsTable();
+        chai
+          .expect(rows[1].assigned_oracles)
+          .deep.equal([
+            oracle2.name,
+            oracle3.name,
+            oracle4.name,
+            oracle5.name,
+            oracle6.name,
+          ]);
+      });
+    });
+  });
+  context('sign with assigned oracles', async () => {
+    it('should fail for an oracle outside the assignment', async () => {
+      await assertEOSErrorIncludesMessage(
+        teleporteos.sign(oracle1.name, 1, 'sig1', '666.0000 TLM', {
+          from: oracle1,
+        }),
+        'Oracle is not assigned to this teleport'
+      );
+    });
+    it('should succeed for any oracle after the assignment timeout', async function () {
+      // ASSIGNMENT_TIMEOUT_SECONDS is 5 in IS_DEV builds
+      this.timeout(20000);
+      await sleep(6000);
+      await teleporteos.sign(oracle1.name, 1, 'sig1', '666.0000 TLM', {
+        from: oracle1,
+      });
+      let { rows } = await teleporteos.teleportsTable();
+      chai.expect(rows[1].signature_count).equal(1);
+    });
+  });
+  context('receivedsig', async () => {
+    const ref =
+      '1111111111111111111111111111111111111111111111111111111111111114';
+    context('setkey', async () => {
+      it('should fail for a non oracle', async () => {
+        await assertEOSErrorIncludesMessage(
+          teleporteos.setkey(sender1.name, sender1.publicKey!, {
+            from: sender1,
+          }),
+          'Account is not an oracle'
+        );
+      });
+      it('should succeed for registered oracles', async () => {
+        for (const oracle of [oracle1, oracle2, oracle3, oracle4, oracle5]) {
+          await teleporteos.setkey(oracle.name, oracle.publicKey!, {
+            from: oracle,
+          });
+        }
+      });
+      it('should fail for a key used by another oracle', async () => {
+        await assertEOSErrorIncludesMessage(
+          teleporteos.setkey(oracle2.name, oracle1.publicKey!, {
+            from: oracle2,
+          }),
+          'Key is already used by another oracle'
+        );
+      });
+    });
+    context('with signatures from a non oracle', async () => {
+      it('should fail', async () => {
+        await assertEOSErrorIncludesMessage(
+          teleporteos.receivedsig(
+            sender2.name,
+            ref,
+            '50.0000 TLM',
+            2,
+            [signReceipt(sender1, sender2.name, ref, '50.0000 TLM', 2)],
+            { from: sender2 }
+          ),
+          'Signature is not from an oracle'
+        );
+      });
+    });
+    context('with too few oracle signatures', async () => {
+      it('should fail', async () => {
+        await assertEOSErrorIncludesMessage(
+          teleporteos.receivedsig(
+            sender2.name,
+            ref,
+            '50.0000 TLM',
+            2,
+            [oracle1, oracle2, oracle2].map((o) =>
+              signReceipt(o, sender2.name, ref, '50.0000 TLM', 2)
+            ),
+            { from: sender2 }
+          ),
+          'Not enough valid signatures'
+        );
+      });
+    });
+    context('with signatures from all oracles', async () => {
+      it('should succeed', async () => {
+        await teleporteos.receivedsig(
+          sender2.name,
+          ref,
+          '50.0000 TLM',
+          2,
+          [oracle1, oracle2, oracle3, oracle4, oracle5].map((o) =>
+            signReceipt(o, sender2.name, ref, '50.0000 TLM', 2)
+          ),
+          { from: sender2 }
+        );
+      });
+      it('should transfer tokens', async () => {
+        await assertRowsEqual(
+          alienworldsToken.accountsTable({ scope: sender2.name }),
+          [{ balance: '50.0000 TLM' }]
+        );
+      });
+      it('should insert a completed receipt', async () => {
+        let { rows } = await teleporteos.receiptsTable();
+        let item = rows[3];
+        chai.expect(item.ref).equal(ref);
+        chai.expect(item.to).equal(sender2.name);
+        chai.expect(item.confirmations).equal(5);
+        chai.expect(item.completed).true;
+        chai.expect(item.completed_time).above(0);
+      });
+      it('should not record a latency sample for a new receipt', async () => {
+        let { rows } = await teleporteos.latencyTable();
+        let received = rows.find((r) => r.stage === 'received');
+        chai.expect(received.count).equal(1);
+      });
+      it('should fail to confirm the receipt again', async () => {
+        await assertEOSErrorIncludesMessage(
+          teleporteos.receivedsig(
+            sender2.name,
+            ref,
+            '50.0000 TLM',
+            2,
+            [oracle1, oracle2, oracle3, oracle4, oracle5].map((o) =>
+              signReceipt(o, sender2.name, ref, '50.0000 TLM', 2)
+            ),
+            { from: sender2 }
+          ),
+          'This teleport has already completed'
+        );
+      });
+    });
+    context('with a different chain than the receipt', async () => {
+      const otherRef =
+        '1111111111111111111111111111111111111111111111111111111111111115';
+      before(async () => {
+        await teleporteos.received(
+          oracle1.name,
+          sender2.name,
+          otherRef,
+          '50.0000 TLM',
+          2,
+          true,
+          { from: oracle1 }
+        );
+      });
+      it('should fail', async () => {
+        await assertEOSErrorIncludesMessage(
+          teleporteos.receivedsig(
+            sender2.name,
+            otherRef,
+            '50.0000 TLM',
+            3,
+            [oracle1, oracle2, oracle3, oracle4, oracle5].map((o) =>
+              signReceipt(o, sender2.name, otherRef, '50.0000 TLM', 3)
+            ),
+            { from: sender2 }
+          ),
+          'Chain mismatch'
+        );
+      });
+    });
+  });
+  context('coalesce', async () => {
+    const coalesceEth =
+      '3333333333333333333333333333333333333333000000000000000000000000';
+    context('without valid auth', async () => {
+      it('should fail with auth error', async () => {
+        await assertMissingAuthority(
+          teleporteos.coalesce(sender1.name, true, { from: sender2 })
+        );
+      });
+    });
+    context('with valid auth', async () => {
+      before(async () => {
+        await alienworldsToken.transfer(
+          sender1.name,
+          teleporteos.account.name,
+          '300.0000 TLM',
+          'coalesce test',
+          { from: sender1 }
+        );
+      });
+      it('should succeed', async () => {
+        await teleporteos.coalesce(sender1.name, true, { from: sender1 });
+      });
+      it('should merge teleports to the same destination', async () => {
+        await teleporteos.teleport(sender1.name, '100.0000 TLM', 2, coalesceEth, {
+          from: sender1,
+        });
+        await teleporteos.teleport(sender1.name, '100.0000 TLM', 2, coalesceEth, {
+          from: sender1,
+        });
+        let { rows } = await teleporteos.teleportsTable();
+        chai.expect(rows.length).equal(3);
+        chai.expect(rows[2].id).equal(2);
+        chai.expect(rows[2].quantity).equal('200.0000 TLM');
+      });
+      it('should not merge into a signed teleport', async () => {
+        await teleporteos.sign(oracle3.name, 2, 'sig3', '200.0000 TLM', {
+          from: oracle3,
+        });
+        await teleporteos.teleport(sender1.name, '100.0000 TLM', 2, coalesceEth, {
+          from: sender1,
+        });
+        let { rows } = await teleporteos.teleportsTable();
+        chai.expect(rows.length).equal(4);
+        chai.expect(rows[2].quantity).equal('200.0000 TLM');
+        chai.expect(rows[3].quantity).equal('100.0000 TLM');
+      });
+      it('should not merge teleports to another address or chain', async () => {
+        const otherEth =
+          '4444444444444444444444444444444444444444000000000000000000000000';
+        await alienworldsToken.transfer(
+          sender1.name,
+          teleporteos.account.name,
+          '200.0000 TLM',
+          'coalesce test',
+          { from: sender1 }
+        );
+        await teleporteos.teleport(sender1.name, '100.0000 TLM', 2, otherEth, {
+          from: sender1,
+        });
+        await teleporteos.teleport(sender1.name, '100.0000 TLM', 3, otherEth, {
+          from: sender1,
+        });
+        let { rows } = await teleporteos.teleportsTable();
+        chai.expect(rows.length).equal(6);
+        chai.expect(rows[3].quantity).equal('100.0000 TLM');
+        chai.expect(rows[4].quantity).equal('100.0000 TLM');
+        chai.expect(rows[4].chain_id).equal(2);
+        chai.expect(rows[5].quantity).equal('100.0000 TLM');
+        chai.expect(rows[5].chain_id).equal(3);
+      });
+    });
+  });
+  context('claim checkpoints', async () => {
+    // bit 0 covers teleport 2, the merged teleport from the coalesce tests
+    const bitmap = '01';
+    const findCheckpoint = async (fromBlock: number) => {
+      let { rows } = await teleporteos.checkpointsTable();
+      return rows.find((r) => r.from_block == fromBlock);
+    };
+    const isClaimed = async (id: number) => {
+      const result = await teleporteos.isclaimed(id, { from: sender1 });
+      return returnValue(result).get() == 1;
+    };
+    context('with unregistered oracle', async () => {
+      it('should fail', async () => {
+        await assertEOSErrorIncludesMessage(
+          teleporteos.claimckpt(sender1.name, 2, 100, 200, 2, bitmap, {
+            from: sender1,
+          }),
+          'Account is not an oracle'
+        );
+      });
+    });
+    context('with a bitmap larger than the maximum', async () => {
+      it('should fail', async () => {
+        await assertEOSErrorIncludesMessage(
+          teleporteos.claimckpt(
+            oracle1.name,
+            2,
+            100,
+            200,
+            2,
+            '00'.repeat(33),
+            { from: oracle1 }
+          ),
+          'Bitmap is too large'
+        );
+      });
+    });
+    context('before quorum', async () => {
+      before(async () => {
+        await teleporteos.claimckpt(oracle1.name, 2, 100, 200, 2, bitmap, {
+          from: oracle1,
+        });
+        await teleporteos.claimckpt(oracle2.name, 2, 100, 200, 2, bitmap, {
+          from: oracle2,
+        });
+      });
+      it('should fail for an oracle that has already submitted', async () => {
+        await assertEOSErrorIncludesMessage(
+          teleporteos.claimckpt(oracle1.name, 2, 100, 200, 2, bitmap, {
+            from: oracle1,
+          }),
+          'Oracle has already submitted checkpoint'
+        );
+      });
+      it('should store the bitmap as bytes', async () => {
+        const checkpoint = await findCheckpoint(100);
+        chai.expect(checkpoint.bitmap).equal(bitmap);
+        chai.expect(checkpoint.oracles).deep.equal([oracle1.name, oracle2.name]);
+      });
+      it('should not sweep', async () => {
+        const checkpoint = await findCheckpoint(100);
+        await assertEOSErrorIncludesMessage(
+          teleporteos.sweepclaims(checkpoint.id, 10, { from: sender1 }),
+          'Checkpoint has not reached quorum'
+        );
+      });
+      it('should not report covered teleports as claimed', async () => {
+        chai.expect(await isClaimed(2)).false;
+      });
+    });
+    context('after quorum', async () => {
+      before(async () => {
+        await teleporteos.claimckpt(oracle3.name, 2, 100, 200, 2, bitmap, {
+          from: oracle3,
+        });
+      });
+      it('should sweep covered teleports', async () => {
+        const checkpoint = await findCheckpoint(100);
+        let { rows } = await teleporteos.teleportsTable();
+        chai.expect(rows[2].claimed).true;
+        chai.expect(rows[2].claimed_time).equal(checkpoint.time);
+        chai.expect(rows[3].claimed).false;
+        chai.expect(checkpoint.swept).equal(8);
+      });
+      it('should add late submissions to the swept checkpoint', async () => {
+        await teleporteos.claimckpt(oracle4.name, 2, 100, 200, 2, bitmap, {
+          from: oracle4,
+        });
+        let { rows } = await teleporteos.checkpointsTable();
+        chai.expect(rows.length).equal(1);
+        chai.expect(rows[0].oracles.length).equal(4);
+      });
+    });
+    context('with more claims than one sweep', async () => {
+      // teleports 3, 4, 6 and 7, CHECKPOINT_SWEEP_ROWS is 1 in IS_DEV builds
+      const pendingBitmap = '1b';
+      const submit = (oracle: Account) =>
+        teleporteos.claimckpt(oracle.name, 2, 201, 300, 3, pendingBitmap, {
+          from: oracle,
+        });
+      before(async () => {
+        for (let i = 0; i < 2; i++) {
+          await teleporteos.injecttel(
+            sender1.name,
+            ethToken,
+            '100.0000 TLM',
+            2,
+            { from: teleporteos.account }
+          );
+        }
+        await submit(oracle1);
+        await submit(oracle2);
+        await submit(oracle3);
+      });
+      it('should only sweep the first teleport on quorum', async () => {
+        let { rows } = await teleporteos.teleportsTable();
+        chai.expect(rows[3].claimed).true;
+        chai.expect(rows[4].claimed).false;
+      });
+      it('should report pending teleports as claimed', async () => {
+        chai.expect(await isClaimed(4)).true;
+        chai.expect(await isClaimed(5)).false;
+      });
+      it('should not cancel a pending teleport', async () => {
+        await assertEOSErrorIncludesMessage(
+          teleporteos.cancel(4, { from: sender1 }),
+          'Teleport is already claimed'
+        );
+      });
+      it('should sweep at most max_rows teleports', async () => {
+        const checkpoint = await findCheckpoint(201);
+        await teleporteos.sweepclaims(checkpoint.id, 1, { from: sender1 });
+        let { rows } = await teleporteos.teleportsTable();
+        chai.expect(rows[4].claimed).true;
+        chai.expect(rows[6].claimed).false;
+        chai.expect(rows[7].claimed).false;
+      });
+      it('should sweep the rest', async () => {
+        const checkpoint = await findCheckpoint(201);
+        await teleporteos.sweepclaims(checkpoint.id, 10, { from: sender1 });
+        let { rows } = await teleporteos.teleportsTable();
+        chai.expect(rows[6].claimed).true;
+        chai.expect(rows[7].claimed).true;
+        chai.expect(rows[5].claimed).false;
+      });
+      it('should date swept claims by the checkpoint submission', async () => {
+        const checkpoint = await findCheckpoint(201);
+        let { rows } = await teleporteos.teleportsTable();
+        chai.expect(rows[7].claimed_time).equal(checkpoint.time);
+
+        let latency = await teleporteos.latencyTable();
+        let claimed = latency.rows.find(
+          (r) => r.chain_id == 2 && r.stage === 'claimed'
+        );
+        chai.expect(claimed.count).equal(5);
+      });
+      it('should not sweep a swept checkpoint again', async () => {
+        const checkpoint = await findCheckpoint(201);
+        await assertEOSErrorIncludesMessage(
+          teleporteos.sweepclaims(checkpoint.id, 10, { from: sender1 }),
+          'Checkpoint is already swept'
+        );
+      });
+    });
+    context('after expiry', async () => {
+      before(async function () {
+        // CHECKPOINT_EXPIRY_SECONDS is 30 in IS_DEV builds
+        this.timeout(60000);
+        await teleporteos.claimckpt(oracle1.name, 3, 301, 400, 5, bitmap, {
+          from: oracle1,
+        });
+        await sleep(31000);
+      });
+      it('should erase a checkpoint which did not reach quorum', async () => {
+        const checkpoint = await findCheckpoint(301);
+        await teleporteos.sweepclaims(checkpoint.id, 10, { from: sender1 });
+        chai.expect(await findCheckpoint(301)).undefined;
+
+        let { rows } = await teleporteos.teleportsTable();
+        chai.expect(rows[5].claimed).false;
+      });
+      it('should prune swept checkpoints on the next submission', async () => {
+        await teleporteos.claimckpt(oracle1.name, 2, 401, 500, 2, bitmap, {
+          from: oracle1,
+        });
+        let { rows } = await teleporteos.checkpointsTable();
+        chai.expect(rows.map((r) => r.from_block)).deep.equal([401]);
+      });
+    });
+  });
+  context('getbalances', async () => {
+    let vester: Account;
+    let noBalance: Account;
+    before(async () => {
+      vester = await AccountManager.createAccount('vester');
+      noBalance = await AccountManager.createAccount('nobalance');
+      await alienworldsToken.transfer(
+        alienworldsToken.account.name,
+        vester.name,
+        '500.0000 TLM',
+        'vesting test',
+        { from: alienworldsToken.account }
+      );
+      // starts tomorrow so the whole amount is still locked
+      const vestingStart = new Date(Date.now() + 24 * 60 * 60 * 1000);
+      await alienworldsToken.addvesting(
+        vester.name,
+        vestingStart.toISOString().slice(0, -5),
+        30 * 24 * 60 * 60,
+        '200.0000 TLM',
+        { from: alienworldsToken.account }
+      );
+    });
+    it('should return balances and vesting locks', async () => {
+      const result = await alienworldsToken.getbalances(
+        [vester.name, noBalance.name],
+        'TLM',
+        { from: sender1 }
+      );
+      const sb = returnValue(result);
+      const balances = [];
+      for (let i = sb.getVarUint32(); i > 0; i--) {
+        balances.push({
+          account: sb.getName(),
+          balance: sb.getAsset(),
+          locked: sb.getAsset(),
+        });
+      }
+      chai.expect(balances).deep.equal([
+        {
+          account: vester.name,
+          balance: '500.0000 TLM',
+          locked: '200.0000 TLM',
+        },
+        {
+          account: noBalance.name,
+          balance: '0.0000 TLM',
+          locked: '0.0000 TLM',
+        },
+      ]);
     });
   });
 });
 
+function sleep(ms: number) {
+  return new Promise((resolve) => setTimeout(resolve, ms));
+}
+
+/* Buffer over the return value of the first action in a transaction */
+function returnValue(result: any) {
+  const trace = result.processed.action_traces[0];
+  return new Serialize.SerialBuffer({
+    textEncoder: new TextEncoder() as any,
+    textDecoder: new TextDecoder() as any,
+    array: Buffer.from(trace.return_value_hex_data, 'hex'),
+  });
+}
+
+/* Returning actions (getbalances, isclaimed) can only be deployed once
+ * ACTION_RETURN_VALUE is active, which the test node does not do on its own */
+async function activateActionReturnValue() {
+  const codename = (feature: any) =>
+    feature.specification.find(
+      (s: any) => s.name == 'builtin_feature_codename'
+    ).value;
+
+  const { activated_protocol_features } = await EOSManager.rpc.fetch(
+    '/v1/chain/get_activated_protocol_features',
+    { limit: 100 }
+  );
+  if (
+    activated_protocol_features.some(
+      (f: any) => codename(f) == 'ACTION_RETURN_VALUE'
+    )
+  ) {
+    return;
+  }
+
+  const supported = await EOSManager.rpc.fetch(
+    '/v1/producer/get_supported_protocol_features',
+    {}
+  );
+  const feature = supported.find(
+    (f: any) => codename(f) == 'ACTION_RETURN_VALUE'
+  );
+  if (!feature) {
+    throw new Error('ACTION_RETURN_VALUE needs a test node on EOSIO 2.1+');
+  }
+
+  try {
+    await EOSManager.transact({
+      actions: [
+        {
+          account: 'eosio',
+          name: 'activate',
+          authorization: [{ actor: 'eosio', permission: 'active' }],
+          data: { feature_digest: feature.feature_digest },
+        },
+      ],
+    });
+  } catch (e: any) {
+    throw new Error(
+      `Could not activate ACTION_RETURN_VALUE, eosio needs a contract with the activate action: ${e.message}`
+    );
+  }
+}
+
+/* Signs the digest checked by receivedsig with the oracle's active key */
+function signReceipt(
+  oracle: Account,
+  to: string,
+  ref: string,
+  quantity: string,
+  chain_id: number
+) {
+  const sb = new Serialize.SerialBuffer({
+    textEncoder: new TextEncoder() as any,
+    textDecoder: new TextDecoder() as any,
+  });
+  sb.pushArray(Buffer.from(RECEIPT_CHAIN_ID, 'hex'));
+  sb.pushName(teleporteos.account.name);
+  sb.pushName(to);
+  sb.pushArray(Buffer.from(ref, 'hex'));
+  sb.pushAsset(quantity);
+  sb.push(chain_id);
+  const digest = createHash('sha256').update(sb.asUint8Array()).digest('hex');
+  return ecc.signHash(digest, oracle.privateKey);
+}
+
 async function seedAccounts() {
+  await activateActionReturnValue();
+
   teleporteos = await ContractDeployer.deployWithName<Teleporteos>(
     'contracts/teleporteos/teleporteos',
     'teleporteos'
@@ -677,6 +1355,7 @@ async function seedAccounts() {
   removedOracle = await AccountManager.createAccount('remoracle');
   oracle4 = await AccountManager.createAccount('oracle4');
   oracle5 = await AccountManager.createAccount('oracle5');
+  oracle6 = await AccountManager.createAccount('oracle6');
 
   await issueTokens();
   await updateAuths();